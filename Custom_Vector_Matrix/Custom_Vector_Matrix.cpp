@@ -24,11 +24,13 @@ public:
 	}
 protected:
 	bool on_draw(const Cairo::RefPtr<Cairo::Context>& cr) {
+		vec<double> points[6];
+		transform(t, corners, points, 6); // move every corner once per frame
 		for (int i = 0; i < 6; i++) { // examine all pairs of points to make lines between them
 			for (int j = 0; j < i; j++) {
 				if (i == j + 3)
 					continue; // skip opposite points. They are spaced 3 apart.
-				vec<double> p1 = t * corners[i], p2 = t * corners[j]; // endpoints
+				const vec<double> &p1 = points[i], &p2 = points[j]; // endpoints
 				cr->move_to(p1[0], p1[1]);
 				cr->line_to(p2[0], p2[1]);
 				cr->set_line_cap(Cairo::LINE_CAP_ROUND );
@@ -74,8 +76,8 @@ protected:
 		dy *= .99;
 		dz *= .95;
 
-		rot = rotdz * rotdy * rotdx * rot; // update orientation with change in rotation
-		t = translate * scale * rot; // combine rotation scaling and translating into position
+		rot = product(rotdz, rotdy, rotdx, rot); // update orientation with change in rotation
+		t = product(translate, scale, rot); // combine rotation scaling and translating into position
 
 		queue_draw();
 		return true;
@@ -10,19 +10,233 @@
  *				: This program requires g++, cstd-11, pthread, and 
  */
 
+#include <cstddef>
+#include <type_traits>
+#if defined(__SSE__)
+#include <immintrin.h>
+#endif
+
+/**
+ * 4x4 matrix product kernels, on row-major arrays of 16 values.
+ * A product is built right to left: load the rightmost matrix into rows,
+ * then apply each matrix to its left with row broadcasts, so a chain of
+ * products keeps the running result in registers until it is stored.
+ * Generic version, with the loops at the fixed size of 4 for the compiler to unroll.
+ */
+template<typename T>
+struct mat4_kernel {
+	struct rows {
+		T r[4][4];
+	};
+	static rows load(const T *b){
+		rows p;
+		for (int i=0; i<4; i++) for (int j=0; j<4; j++) p.r[i][j] = b[4*i+j];
+		return p;
+	}
+	/**
+	 * rows of a*b, for the matrix a and rows b
+	 */
+	static rows apply(const T *a, const rows &b){
+		rows p;
+		for (int i=0; i<4; i++){
+			for (int j=0; j<4; j++){
+				p.r[i][j] = a[4*i]*b.r[0][j]+a[4*i+1]*b.r[1][j]+a[4*i+2]*b.r[2][j]+a[4*i+3]*b.r[3][j];
+			}
+		}
+		return p;
+	}
+	static void store(const rows &p, T *out){
+		for (int i=0; i<4; i++) for (int j=0; j<4; j++) out[4*i+j] = p.r[i][j];
+	}
+};
+
+#if defined(__SSE__)
+/**
+ * float version of mat4_kernel, one SSE register per row: each row of the
+ * product is the four rows of b scaled by broadcasts of one row of a.
+ */
+template<>
+struct mat4_kernel<float> {
+	struct rows {
+		__m128 r0, r1, r2, r3;
+	};
+	static rows load(const float *b){
+		rows p = {_mm_loadu_ps(b), _mm_loadu_ps(b+4), _mm_loadu_ps(b+8), _mm_loadu_ps(b+12)};
+		return p;
+	}
+	static __m128 row(const float *a, const rows &b){
+		return _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(a[0]), b.r0), _mm_mul_ps(_mm_set1_ps(a[1]), b.r1)),
+						  _mm_add_ps(_mm_mul_ps(_mm_set1_ps(a[2]), b.r2), _mm_mul_ps(_mm_set1_ps(a[3]), b.r3)));
+	}
+	static rows apply(const float *a, const rows &b){
+		rows p = {row(a, b), row(a+4, b), row(a+8, b), row(a+12, b)};
+		return p;
+	}
+	static void store(const rows &p, float *out){
+		_mm_storeu_ps(out, p.r0);
+		_mm_storeu_ps(out+4, p.r1);
+		_mm_storeu_ps(out+8, p.r2);
+		_mm_storeu_ps(out+12, p.r3);
+	}
+};
+#endif
+
+#if defined(__AVX__)
+/**
+ * double version of mat4_kernel, one AVX register per row.
+ */
+template<>
+struct mat4_kernel<double> {
+	struct rows {
+		__m256d r0, r1, r2, r3;
+	};
+	static rows load(const double *b){
+		rows p = {_mm256_loadu_pd(b), _mm256_loadu_pd(b+4), _mm256_loadu_pd(b+8), _mm256_loadu_pd(b+12)};
+		return p;
+	}
+	static __m256d row(const double *a, const rows &b){
+		return _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(_mm256_set1_pd(a[0]), b.r0), _mm256_mul_pd(_mm256_set1_pd(a[1]), b.r1)),
+							 _mm256_add_pd(_mm256_mul_pd(_mm256_set1_pd(a[2]), b.r2), _mm256_mul_pd(_mm256_set1_pd(a[3]), b.r3)));
+	}
+	static rows apply(const double *a, const rows &b){
+		rows p = {row(a, b), row(a+4, b), row(a+8, b), row(a+12, b)};
+		return p;
+	}
+	static void store(const rows &p, double *out){
+		_mm256_storeu_pd(out, p.r0);
+		_mm256_storeu_pd(out+4, p.r1);
+		_mm256_storeu_pd(out+8, p.r2);
+		_mm256_storeu_pd(out+12, p.r3);
+	}
+};
+#endif
+
+/**
+ * Base of the element-wise expressions over vec and mat.
+ * Each expression E has the element type value_type, the vec or mat type
+ * it evaluates to as result, its number of elements as size, and at(i) for
+ * element i in row-major order. Sums, differences and scalings build nested
+ * expressions instead of temporaries, and the whole expression is computed
+ * in one loop when it is assigned to a vec or mat.
+ */
+template<typename E>
+struct expr {
+	const E &self() const {
+		return static_cast<const E&>(*this);
+	}
+};
+
+template <typename T, int n> class vec;
+template <typename T, int n, int m> class mat;
+
+/**
+ * How an expression holds an operand: vec and mat by reference, nested
+ * expressions by value, so an expression never refers to a dead temporary.
+ */
+template<typename E>
+struct operand {
+	typedef E type;
+};
+template<typename T, int n>
+struct operand<vec<T, n> > {
+	typedef const vec<T, n> &type;
+};
+template<typename T, int n, int m>
+struct operand<mat<T, n, m> > {
+	typedef const mat<T, n, m> &type;
+};
+
+struct add_op {
+	template<typename T>
+	static T apply(T x, T y){
+		return x+y;
+	}
+};
+struct sub_op {
+	template<typename T>
+	static T apply(T x, T y){
+		return x-y;
+	}
+};
+
+/**
+ * Element-wise l op r, for operands of the same vec or mat type.
+ */
+template<typename L, typename R, typename op>
+struct binary_expr : expr<binary_expr<L, R, op> > {
+	typedef typename L::value_type value_type;
+	typedef typename L::result result;
+	static const int size = L::size;
+	typename operand<L>::type l;
+	typename operand<R>::type r;
+	binary_expr(const L &l, const R &r) : l(l), r(r){
+		static_assert(std::is_same<result, typename R::result>::value, "operands must have the same type and shape");
+	}
+	value_type at(int i) const {
+		return op::apply(l.at(i), r.at(i));
+	}
+};
+
+/**
+ * Every element of e times the scalar s.
+ */
+template<typename E>
+struct scaled_expr : expr<scaled_expr<E> > {
+	typedef typename E::value_type value_type;
+	typedef typename E::result result;
+	static const int size = E::size;
+	typename operand<E>::type e;
+	value_type s;
+	scaled_expr(const E &e, value_type s) : e(e), s(s){}
+	value_type at(int i) const {
+		return e.at(i)*s;
+	}
+};
+
+/**
+ * Element-wise sum of two vectors or two matrices.
+ */
+template<typename L, typename R>
+binary_expr<L, R, add_op> operator+(const expr<L> &x, const expr<R> &y){
+	return binary_expr<L, R, add_op>(x.self(), y.self());
+}
+/**
+ * Element-wise difference of two vectors or two matrices.
+ */
+template<typename L, typename R>
+binary_expr<L, R, sub_op> operator-(const expr<L> &x, const expr<R> &y){
+	return binary_expr<L, R, sub_op>(x.self(), y.self());
+}
+/**
+ * A vector or matrix scaled by s, on either side.
+ */
+template<typename E>
+scaled_expr<E> operator*(const expr<E> &x, typename E::value_type s){
+	return scaled_expr<E>(x.self(), s);
+}
+template<typename E>
+scaled_expr<E> operator*(typename E::value_type s, const expr<E> &x){
+	return scaled_expr<E>(x.self(), s);
+}
+
 /**
  * Vec class to handle our vector components.
  */
 template <typename T = double, int n = 4>
-class vec {
+class vec : public expr<vec<T, n> > {
 	T arr[n];
 public:
+	typedef T value_type;
+	typedef vec result;
+	static const int size = n;
 	/**
 	 * Default vec constructor.
 	 * Pre: a vec call without any parameters.
-	 * Post: a vec object with and array of 0,0,0,1 for it's values.
+	 * Post: a vec object with and array of 0,0,0,1 for it's values (0s and a last 1 for any n).
 	 */
-	vec() : arr{0, 0, 0, 1}{}
+	vec() : arr{}{
+		arr[n-1] = 1;
+	}
 	/**
 	 * Overloaded vec constructor.
 	 * takes params x0,x1,x2,x3 and inserts them into the vec object array.
@@ -32,17 +246,39 @@ public:
 	 * Copy constructor for vec class.
 	 * @param x Vector we want to copy
 	 */
-	vec(const vec<T> &x){
+	vec(const vec &x){
 		for (int i=0; i<n; i++){
 			(*this)[i] = x[i];
 		}
 	}
-	vec<T> operator=(const vec<T> &x){
+	/**
+	 * Constructor that evaluates an element-wise expression such as a + b - c.
+	 * @param x expression of vectors we want the value of
+	 */
+	template<typename E, typename std::enable_if<std::is_same<vec, typename E::result>::value, int>::type = 0>
+	vec(const expr<E> &x){
+		*this = x;
+	}
+	vec &operator=(const vec &x){
 		for (int i=0; i<n; i++){
 			(*this)[i] = x[i];
 		}
 		return *this;
 	}
+	/**
+	 * Assigns an element-wise expression, computing it in a single loop.
+	 * @param x expression of vectors, like a + b - c
+	 * @return the vector with the value of the expression.
+	 */
+	template<typename E>
+	vec &operator=(const expr<E> &x){
+		static_assert(std::is_same<vec, typename E::result>::value, "expression must give this vec type");
+		const E &e = x.self();
+		for (int i=0; i<n; i++){
+			arr[i] = e.at(i);
+		}
+		return *this;
+	}
 	/**
 	 * Overloaded subscript operator to return an address to a spot in the array.
 	 * @param i index of the array we're interested in
@@ -60,57 +296,47 @@ public:
 		return arr[i];
 	}
 	/**
-	 * Overloaded multiplication assignment operator for vectors.
-	 * @param x vector we are going to multiply by.
-	 * @return an augmented vector that has the other vector multiplied into it.
+	 * Element i, for expressions.
 	 */
-	vec<T> operator*=(T x){
-		for (int i=0; i<n; i++){
-			arr[i]=arr[i]*x;
-		}
-		return *this;
+	T at(int i) const{
+		return arr[i];
 	}
 	/**
-	 * Overloaded addition operator for vector addition.
-	 * @param x vector we want to add to our vector.
-	 * @return a vector with the sun of the two vectors.
+	 * Overloaded multiplication assignment operator for vectors.
+	 * @param x scalar we are going to multiply by.
+	 * @return the vector with every component multiplied by x.
 	 */
-	vec<T> operator+(const vec<T> &x){
-		vec<T> y(0,0,0,0);
+	vec &operator*=(T x){
 		for (int i=0; i<n; i++){
-			y[i] = arr[i]+x[i];
+			arr[i]=arr[i]*x;
 		}
-		return y;
+		return *this;
 	}
 	/**
 	 * Overloaded Addition assignment operator for vectors.
-	 * @param x vector we are adding to our current vector
+	 * @param x vector, or expression of vectors, we are adding to our current vector
 	 * @return the original vector with the second vector added to it.
 	 */
-	vec<T> operator+=(const vec<T> &x){
+	template<typename E>
+	vec &operator+=(const expr<E> &x){
+		static_assert(std::is_same<vec, typename E::result>::value, "expression must give this vec type");
+		const E &e = x.self();
 		for (int i=0; i<n; i++){
-			arr[i] = arr[i] + x[i];
+			arr[i] = arr[i] + e.at(i);
 		}
 		return *this;
 	}
-	/**
-	 * Overloaded subtraction operator for vectors.
-	 * @param x vector we want to subtract from our working vector.
-	 * @return difference of the two vectors.
-	 */
-	vec<T> operator-(const vec<T> &x){
-		vec<T> y(0,0,0,0);
-		for (int i=0; i<n; i++) y[i] = arr[i]-x[i];
-		return y;
-	}
 	/**
 	 * Overloaded subtraction assignment operator for vectors.
-	 * @param x the vector we are subtracting from our working vector.
+	 * @param x the vector, or expression of vectors, we are subtracting from our working vector.
 	 * @return the original vector less the second vector.
 	 */
-	vec<T> operator-=(const vec<T> &x){
+	template<typename E>
+	vec &operator-=(const expr<E> &x){
+		static_assert(std::is_same<vec, typename E::result>::value, "expression must give this vec type");
+		const E &e = x.self();
 		for (int i=0; i<n; i++){
-			arr[i] = arr[i] - x[i];
+			arr[i] = arr[i] - e.at(i);
 		}
 		return *this;
 	}
@@ -121,7 +347,7 @@ public:
 	 * @return return ostream& object with the vector info in it.
 	 */
 	template <class os>
-	friend os &operator<<(os &out,const vec<T> a) {
+	friend os &operator<<(os &out,const vec &a) {
 		for(int i=0; i<n; i++) out << a[i] << ' ';
 		out << (char)10;
 		return out;
@@ -131,18 +357,20 @@ public:
  * mat class to hold our matrix information.
  */
 template <typename T = double, int n = 4, int m = 4>
-class mat {
+class mat : public expr<mat<T, n, m> > {
 	T a[n][m];
 public:
+	typedef T value_type;
+	typedef mat result;
+	static const int size = n*m;
 	/**
 	 * Default constructor for mat class.
 	 * Pre: Initialize call for mat class.
-	 * Post: mat object with a 4x4 array with 1 in the diagonal.
+	 * Post: mat object with 1 in the diagonal and 0s elsewhere, for any n x m.
 	 */
-	mat() : a{1,0,0,0,
-			  0,1,0,0,
-			  0,0,1,0,
-			  0,0,0,1}{}
+	mat() : a{}{
+		for (int i=0; i<(n<m ? n : m); i++) a[i][i] = 1;
+	}
 	/**
 	 * Overloaded constructor for mat class.
 	 * Pre: Takes 16 parameters then initializes the matrix in that order.
@@ -158,13 +386,13 @@ public:
 				  x1,x2,x3,x4}{}
 	/**
 	 * Overloaded mat constructor to create a matrix with x for the diagonal and 0s elsewhere.
-	 * @param x Value of the diagonal in the 4x4 matrix
+	 * @param x Value of the diagonal in the n x m matrix
 	 * Returns a matrix with x as the diagonal.
+	 * Explicit, so a scalar is never taken for a matrix in mixed expressions.
 	 */
-	mat(T x) : a{x, 0, 0, 0,
-				 0, x, 0, 0,
-				 0, 0, x, 0,
-				 0, 0, 0, x}{}
+	explicit mat(T x) : a{}{
+		for (int i=0; i<(n<m ? n : m); i++) a[i][i] = x;
+	}
 	/**
 	 * Matrix copy constructor for the rule of five.
 	 * @param old The matrix we want to copy.
@@ -181,7 +409,7 @@ public:
 	 * @param em matrix we want to assign the value from.
 	 * @return the working matrix with the values of em.
 	 */
-	mat<T>& operator=(const mat& em){
+	mat& operator=(const mat& em){
 		for (int i=0; i<n; i++){
 			for (int j=0; j<m; j++){
 				this->a[i][j] = em[i][j];
@@ -189,6 +417,29 @@ public:
 		}
 		return *this;
 	}
+	/**
+	 * Constructor that evaluates an element-wise expression such as a + b - c.
+	 * @param x expression of matrices we want the value of
+	 */
+	template<typename E, typename std::enable_if<std::is_same<mat, typename E::result>::value, int>::type = 0>
+	mat(const expr<E> &x){
+		*this = x;
+	}
+	/**
+	 * Assigns an element-wise expression, computing it in a single loop.
+	 * @param x expression of matrices, like a + b - c
+	 * @return the matrix with the value of the expression.
+	 */
+	template<typename E>
+	mat& operator=(const expr<E> &x){
+		static_assert(std::is_same<mat, typename E::result>::value, "expression must give this mat type");
+		const E &e = x.self();
+		T *p = a[0];
+		for (int i=0; i<n*m; i++){
+			p[i] = e.at(i);
+		}
+		return *this;
+	}
 	/**
 	 * Default mat destructor
 	 */
@@ -209,20 +460,22 @@ public:
 	T const *operator[](int i) const {
 		return a[i];
 	}
+	/**
+	 * Element i in row-major order, for expressions.
+	 */
+	T at(int i) const {
+		const T *p = a[0];
+		return p[i];
+	}
 	/**
 	 * Overloaded * operator for matrix multiplication
 	 * @param x Matrix we want to multiply our matrix by.
 	 * @return a matrix with the multiplied values in it.
 	 */
 	mat<T> operator*(const mat<T> &x) const {
-		mat<T> y{0};
-		for (int i=0; i<n; i++){
-			for (int j=0; j<n; j++){
-				for (int k=0; k<m; k++){
-					y[i][j] += a[i][k]*x[k][j];
-				}
-			}
-		}
+		static_assert(n==4 && m==4, "matrix products are for 4x4 matrices");
+		mat<T> y;
+		mat4_kernel<T>::store(mat4_kernel<T>::apply(a[0], mat4_kernel<T>::load(x[0])), y[0]);
 		return y;
 	}
 	/**
@@ -231,6 +484,7 @@ public:
 	 * @return a vector with the multiplied values.
 	 */
 	vec<T> operator*(const vec<T> &x) const {
+		static_assert(n==4 && m==4, "matrix products are for 4x4 matrices");
 		vec<T> y;
 		for (int i=0; i<n; i++){
 			y[i] = 0;
@@ -245,23 +499,17 @@ public:
 	 * @param x Matrix we want to multiply our working matrix by.
 	 * @return The result of multiplying the two matrices.
 	 */
-	mat<T> operator*=(const mat<T> &x){
-		mat<T> y{0};
-		for (int i=0; i<n; i++){
-			for (int j=0; j<n; j++){
-				for (int k=0; k<m; k++){
-					y[i][j] += (*this)[i][k]*x[k][j];
-				}
-			}
-		}
-		return *this = y;
+	mat& operator*=(const mat<T> &x){
+		static_assert(n==4 && m==4, "matrix products are for 4x4 matrices");
+		mat4_kernel<T>::store(mat4_kernel<T>::apply(a[0], mat4_kernel<T>::load(x[0])), a[0]);
+		return *this;
 	}
 	/**
 	 * Overloaded matrix assignment operator to multiply a matrix by a scalar.
 	 * @param x scalar quantity.
 	 * @return a matrix that has been multiplied by x.
 	 */
-	mat<T> operator*=(T x){
+	mat& operator*=(T x){
 		for (int i=0; i<n; i++){
 			for (int j=0; j<m; j++){
 				a[i][j] = a[i][j]*x;
@@ -269,57 +517,33 @@ public:
 		}
 		return *this;
 	}
-	/**
-	 * Overloaded addition operator for matrix addition.
-	 * @param x The matrix we want to add.
-	 * @return A matrix with the sum of the two matrices.
-	 */
-	mat<T> operator+(const mat<T> &x){
-		mat<T> y{0};
-		for (int i=0; i<n; i++){
-			for (int j=0; j<n; j++){
-				y[i][j] = (*this)[i][j]+x[i][j];
-			}
-		}
-		return y;
-	}
 	/**
 	 * Overloaded addition assignment operator for matrix addition.
-	 * @param x Matrix we are adding to the working matrix.
+	 * @param x Matrix, or expression of matrices, we are adding to the working matrix.
 	 * @return the original matrix with the new matrix added to it.
 	 */
-	mat<T> operator+=(const mat<T> &x){
-		for (int i=0; i<n; i++){
-			for (int j=0; j<m; j++){
-				a[i][j] = a[i][j]+x[i][j];
-			}
+	template<typename E>
+	mat& operator+=(const expr<E> &x){
+		static_assert(std::is_same<mat, typename E::result>::value, "expression must give this mat type");
+		const E &e = x.self();
+		T *p = a[0];
+		for (int i=0; i<n*m; i++){
+			p[i] = p[i]+e.at(i);
 		}
 		return *this;
 	}
-	/**
-	 * Overloaded subtraction operator for matrix subtraction.
-	 * @param x Matrix we are subtracting from the calling matrix.
-	 * @return a matrix with the difference of the two matrices.
-	 */
-	mat<T> operator-(const mat<T> &x){
-		mat<T> y{0};
-		for (int i=0; i<n; i++){
-			for (int j=0; j<n; j++){
-				y[i][j] = (*this)[i][j]-x[i][j];
-			}
-		}
-		return y;
-	}
 	/**
 	 * Overloaded subtraction assignment operator for matrix subtraction.
-	 * @param x matrix we want to subtract from the working matrix.
+	 * @param x matrix, or expression of matrices, we want to subtract from the working matrix.
 	 * @return the original matrix with the new matrix subtracted from it.
 	 */
-	mat<T> operator-=(const mat<T> &x){
-		for (int i=0; i<n; i++){
-			for (int j=0; j<m; j++){
-				a[i][j] = a[i][j]-x[i][j];
-			}
+	template<typename E>
+	mat& operator-=(const expr<E> &x){
+		static_assert(std::is_same<mat, typename E::result>::value, "expression must give this mat type");
+		const E &e = x.self();
+		T *p = a[0];
+		for (int i=0; i<n*m; i++){
+			p[i] = p[i]-e.at(i);
 		}
 		return *this;
 	}
@@ -330,7 +554,7 @@ public:
 	 * @return an os& with the data of the matrix and formatting.
 	 */
 	template <class os>
-	friend os &operator<<(os &out,mat<T> a) {
+	friend os &operator<<(os &out,const mat &a) {
 	  for (int i=0; i<n; i++){
 		  for (int j=0; j<m; j++){
 			  out << a[i][j] << ' ';
@@ -356,3 +580,138 @@ mat<T> transpose(const mat<T> &x){
 	}
 	return y;
 }
+
+/**
+ * Rows of the product a*b*c*... for product, built from the right.
+ */
+template<typename T>
+typename mat4_kernel<T>::rows chain(const mat<T> &a){
+	return mat4_kernel<T>::load(a[0]);
+}
+template<typename T, typename... M>
+typename mat4_kernel<T>::rows chain(const mat<T> &a, const M&... rest){
+	return mat4_kernel<T>::apply(a[0], chain<T>(rest...));
+}
+
+/**
+ * Fused product of a chain of matrices, like rotdz * rotdy * rotdx * rot.
+ * The partial products stay in registers instead of going through a
+ * temporary mat for every operator*.
+ * @return a*b*c*...
+ */
+template<typename T, typename... M>
+mat<T> product(const mat<T> &a, const M&... rest){
+	mat<T> y;
+	mat4_kernel<T>::store(chain(a, rest...), y[0]);
+	return y;
+}
+
+/**
+ * Transforms count points by t: out[p] = t * in[p] for every p.
+ * Generic version, also used for the tail of the SIMD versions.
+ * in and out may be the same array.
+ */
+template<typename T>
+void transform(const mat<T> &t, const vec<T> *in, vec<T> *out, std::size_t count){
+	for (std::size_t p=0; p<count; p++){
+		const vec<T> x = in[p];
+		for (int i=0; i<4; i++){
+			out[p][i] = t[i][0]*x[0]+t[i][1]*x[1]+t[i][2]*x[2]+t[i][3]*x[3];
+		}
+	}
+}
+
+#if defined(__AVX__)
+/**
+ * Transposes the 4x4 block of doubles in r0..r3, one point per register,
+ * into one coordinate per register, and back again.
+ */
+inline void transpose4(__m256d &r0, __m256d &r1, __m256d &r2, __m256d &r3){
+	__m256d t0 = _mm256_unpacklo_pd(r0, r1), t1 = _mm256_unpackhi_pd(r0, r1);
+	__m256d t2 = _mm256_unpacklo_pd(r2, r3), t3 = _mm256_unpackhi_pd(r2, r3);
+	r0 = _mm256_permute2f128_pd(t0, t2, 0x20);
+	r1 = _mm256_permute2f128_pd(t1, t3, 0x20);
+	r2 = _mm256_permute2f128_pd(t0, t2, 0x31);
+	r3 = _mm256_permute2f128_pd(t1, t3, 0x31);
+}
+
+/**
+ * double version of transform, 4 points at a time with AVX: each block is
+ * turned into structure-of-arrays form (x, y, z, w of four points in four
+ * registers) so every row of t is applied to four points per instruction.
+ */
+inline void transform(const mat<double> &t, const vec<double> *in, vec<double> *out, std::size_t count){
+	__m256d a[4][4];
+	for (int i=0; i<4; i++) for (int j=0; j<4; j++) a[i][j] = _mm256_set1_pd(t[i][j]);
+	const double *src = reinterpret_cast<const double*>(in);
+	double *dst = reinterpret_cast<double*>(out);
+	std::size_t p = 0;
+	for (; p+4<=count; p+=4){
+		__m256d x = _mm256_loadu_pd(src+4*p), y = _mm256_loadu_pd(src+4*p+4);
+		__m256d z = _mm256_loadu_pd(src+4*p+8), w = _mm256_loadu_pd(src+4*p+12);
+		transpose4(x, y, z, w);
+		__m256d r[4];
+		for (int i=0; i<4; i++){
+			r[i] = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(a[i][0], x), _mm256_mul_pd(a[i][1], y)),
+								 _mm256_add_pd(_mm256_mul_pd(a[i][2], z), _mm256_mul_pd(a[i][3], w)));
+		}
+		transpose4(r[0], r[1], r[2], r[3]);
+		for (int i=0; i<4; i++) _mm256_storeu_pd(dst+4*(p+i), r[i]);
+	}
+	transform<double>(t, in+p, out+p, count-p);
+}
+#endif
+
+#if defined(__SSE__)
+/**
+ * float version of transform, 8 points at a time with AVX and 4 with SSE,
+ * in structure-of-arrays form like the double version. With AVX each
+ * register holds two points, and the 4x4 transposes run in both 128-bit
+ * halves at once, so each block comes back in the order it went in.
+ */
+inline void transform(const mat<float> &t, const vec<float> *in, vec<float> *out, std::size_t count){
+	const float *src = reinterpret_cast<const float*>(in);
+	float *dst = reinterpret_cast<float*>(out);
+	std::size_t p = 0;
+#if defined(__AVX__)
+	__m256 a[4][4];
+	for (int i=0; i<4; i++) for (int j=0; j<4; j++) a[i][j] = _mm256_set1_ps(t[i][j]);
+	for (; p+8<=count; p+=8){
+		__m256 x = _mm256_loadu_ps(src+4*p), y = _mm256_loadu_ps(src+4*p+8);
+		__m256 z = _mm256_loadu_ps(src+4*p+16), w = _mm256_loadu_ps(src+4*p+24);
+		__m256 t0 = _mm256_unpacklo_ps(x, y), t1 = _mm256_unpackhi_ps(x, y);
+		__m256 t2 = _mm256_unpacklo_ps(z, w), t3 = _mm256_unpackhi_ps(z, w);
+		x = _mm256_shuffle_ps(t0, t2, 0x44);
+		y = _mm256_shuffle_ps(t0, t2, 0xEE);
+		z = _mm256_shuffle_ps(t1, t3, 0x44);
+		w = _mm256_shuffle_ps(t1, t3, 0xEE);
+		__m256 r[4];
+		for (int i=0; i<4; i++){
+			r[i] = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(a[i][0], x), _mm256_mul_ps(a[i][1], y)),
+								 _mm256_add_ps(_mm256_mul_ps(a[i][2], z), _mm256_mul_ps(a[i][3], w)));
+		}
+		t0 = _mm256_unpacklo_ps(r[0], r[1]), t1 = _mm256_unpackhi_ps(r[0], r[1]);
+		t2 = _mm256_unpacklo_ps(r[2], r[3]), t3 = _mm256_unpackhi_ps(r[2], r[3]);
+		_mm256_storeu_ps(dst+4*p, _mm256_shuffle_ps(t0, t2, 0x44));
+		_mm256_storeu_ps(dst+4*p+8, _mm256_shuffle_ps(t0, t2, 0xEE));
+		_mm256_storeu_ps(dst+4*p+16, _mm256_shuffle_ps(t1, t3, 0x44));
+		_mm256_storeu_ps(dst+4*p+24, _mm256_shuffle_ps(t1, t3, 0xEE));
+	}
+#endif
+	__m128 b[4][4];
+	for (int i=0; i<4; i++) for (int j=0; j<4; j++) b[i][j] = _mm_set1_ps(t[i][j]);
+	for (; p+4<=count; p+=4){
+		__m128 x = _mm_loadu_ps(src+4*p), y = _mm_loadu_ps(src+4*p+4);
+		__m128 z = _mm_loadu_ps(src+4*p+8), w = _mm_loadu_ps(src+4*p+12);
+		_MM_TRANSPOSE4_PS(x, y, z, w);
+		__m128 r[4];
+		for (int i=0; i<4; i++){
+			r[i] = _mm_add_ps(_mm_add_ps(_mm_mul_ps(b[i][0], x), _mm_mul_ps(b[i][1], y)),
+							  _mm_add_ps(_mm_mul_ps(b[i][2], z), _mm_mul_ps(b[i][3], w)));
+		}
+		_MM_TRANSPOSE4_PS(r[0], r[1], r[2], r[3]);
+		for (int i=0; i<4; i++) _mm_storeu_ps(dst+4*(p+i), r[i]);
+	}
+	transform<float>(t, in+p, out+p, count-p);
+}
+#endif
@@ -0,0 +1,304 @@
+//============================================================================
+// Name        : Custom_Vector_Matrix_bench.cpp
+// Author      : Matthew Brown
+// Description : Timing runs for the vec and mat kernels, without GTK
+//				 Build with: g++ -std=c++11 -O2 -march=native Custom_Vector_Matrix_bench.cpp
+//				 Runs every section, or only the ones named: ./a.out transform
+//============================================================================
+
+#include "Custom_Vector_Matrix.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+static int failures = 0;	// checks that came out wrong; main exits non-zero if any did
+
+/**
+ * Seconds elapsed while running f once.
+ */
+template<typename fn>
+static double seconds(fn f) {
+	auto start = chrono::steady_clock::now();
+	f();
+	return chrono::duration<double>(chrono::steady_clock::now()-start).count();
+}
+
+/**
+ * A random rotation-and-shift sized transform, the shape of t in on_timeout.
+ */
+template<typename T>
+static mat<T> random_mat(mt19937 &rng) {
+	uniform_real_distribution<double> d(-1, 1);
+	return mat<T>(d(rng), d(rng), d(rng), 100*d(rng),
+				  d(rng), d(rng), d(rng), 100*d(rng),
+				  d(rng), d(rng), d(rng), 100*d(rng),
+				  0, 0, 0, 1);
+}
+
+/**
+ * Whether x and y agree to within rounding, relative to the largest entry of y.
+ */
+template<typename T>
+static bool near(const mat<T> &x, const mat<T> &y) {
+	T scale = 1;
+	for (int i=0; i<4; i++) for (int j=0; j<4; j++) scale = max<T>(scale, abs(y[i][j]));
+	for (int i=0; i<4; i++)
+		for (int j=0; j<4; j++)
+			if (abs(x[i][j]-y[i][j]) > 256*numeric_limits<T>::epsilon()*scale) return false;
+	return true;
+}
+template<typename T>
+static bool near(const vec<T> &x, const vec<T> &y) {
+	T scale = 1;
+	for (int i=0; i<4; i++) scale = max<T>(scale, abs(y[i]));
+	for (int i=0; i<4; i++)
+		if (abs(x[i]-y[i]) > 256*numeric_limits<T>::epsilon()*scale) return false;
+	return true;
+}
+
+/**
+ * Points per second for count points through operator* one at a time and
+ * through transform, repeated to cover about 2*10^7 points either way.
+ * Every component of every transformed point is checked against operator*.
+ */
+template<typename T>
+static void transform_rate(const char *type, size_t count) {
+	mt19937 rng(321);
+	uniform_real_distribution<double> d(-1, 1);
+	mat<T> t = random_mat<T>(rng);
+	vector<vec<T>> in(count), out(count);
+	for (vec<T> &v : in) v = vec<T>(d(rng), d(rng), d(rng), 1);
+	size_t repeats = max<size_t>(1, 20000000/count);
+	double loop = seconds([&]{
+		for (size_t r=0; r<repeats; r++)
+			for (size_t p=0; p<count; p++) out[p] = t*in[p];
+	});
+	double batch = seconds([&]{
+		for (size_t r=0; r<repeats; r++) transform(t, in.data(), out.data(), count);
+	});
+	bool same = true;
+	for (size_t p=0; p<count; p++) same = same && near(out[p], t*in[p]);
+	failures += !same;
+	double points = double(count)*repeats;
+	printf("  %-6s %9zu %12.1f %12.1f %8.2fx  %s\n", type, count, points/loop/1e6, points/batch/1e6, loop/batch,
+			same ? "same" : "DIFFERENT");
+}
+
+/**
+ * Batched transform against looping operator*, 10^3 to 10^7 points, and a
+ * count that leaves a tail after the last full batch of four or eight.
+ */
+static void transforming() {
+	printf("transform: million points per second\n");
+	printf("  %-6s %9s %12s %12s %9s\n", "type", "points", "operator*", "transform", "speedup");
+	transform_rate<float>("float", 1007);
+	transform_rate<double>("double", 1007);
+	for (size_t count=1000; count<=10000000; count*=10) {
+		transform_rate<float>("float", count);
+		transform_rate<double>("double", count);
+	}
+}
+
+/**
+ * The triple loop operator* used to be, starting from the diagonal-only
+ * constructor, kept to time the kernels against.
+ */
+template<typename T>
+static mat<T> loop_multiply(const mat<T> &x, const mat<T> &y) {
+	mat<T> z{0};
+	for (int i=0; i<4; i++)
+		for (int j=0; j<4; j++)
+			for (int k=0; k<4; k++) z[i][j] += x[i][k]*y[k][j];
+	return z;
+}
+
+/**
+ * ns per 4x4 multiply and per four-matrix chain, over a ring of random
+ * matrices so nothing is folded away.
+ */
+template<typename T>
+static void multiply_rate(const char *type) {
+	const int size = 1024, repeats = 2000;
+	mt19937 rng(321);
+	vector<mat<T>> ms(size), out(size);
+	for (mat<T> &x : ms) x = random_mat<T>(rng);
+	auto at = [&](int i) -> const mat<T>& { return ms[i&(size-1)]; };
+	double calls = double(size)*repeats;
+	double loop = seconds([&]{
+		for (int r=0; r<repeats; r++) for (int i=0; i<size; i++) out[i] = loop_multiply(ms[i], at(i+1));
+	});
+	double kernel = seconds([&]{
+		for (int r=0; r<repeats; r++) for (int i=0; i<size; i++) out[i] = ms[i]*at(i+1);
+	});
+	double loops = seconds([&]{
+		for (int r=0; r<repeats; r++)
+			for (int i=0; i<size; i++) out[i] = loop_multiply(loop_multiply(loop_multiply(ms[i], at(i+1)), at(i+2)), at(i+3));
+	});
+	double ops = seconds([&]{
+		for (int r=0; r<repeats; r++) for (int i=0; i<size; i++) out[i] = ms[i]*at(i+1)*at(i+2)*at(i+3);
+	});
+	double fused = seconds([&]{
+		for (int r=0; r<repeats; r++) for (int i=0; i<size; i++) out[i] = product(ms[i], at(i+1), at(i+2), at(i+3));
+	});
+	bool same = true;
+	for (int i=0; i<size; i++) {
+		mat<T> ab = loop_multiply(ms[i], at(i+1)), abcd = loop_multiply(loop_multiply(ab, at(i+2)), at(i+3));
+		same = same && near(ms[i]*at(i+1), ab) && near(ms[i]*at(i+1)*at(i+2)*at(i+3), abcd)
+				&& near(product(ms[i], at(i+1), at(i+2), at(i+3)), abcd);
+	}
+	failures += !same;
+	printf("  %-6s %-10s %8.2f %8.2f\n", type, "a*b", loop*1e9/calls, kernel*1e9/calls);
+	printf("  %-6s %-10s %8.2f %8.2f %8.2f  %s\n", type, "a*b*c*d", loops*1e9/calls, ops*1e9/calls, fused*1e9/calls,
+			same ? "same" : "DIFFERENT");
+}
+
+/**
+ * 4x4 kernels against the old triple loop: single products, and the
+ * four-matrix chain of on_timeout through operator* and through product.
+ */
+static void multiplying() {
+	printf("multiply: ns per product\n");
+	printf("  %-6s %-10s %8s %8s %8s\n", "type", "", "loop", "kernel", "product");
+	multiply_rate<float>("float");
+	multiply_rate<double>("double");
+}
+
+/**
+ * z = x op y over size elements, the full pass into a temporary that
+ * operator+ and operator- used to make for every operator.
+ */
+template<typename op>
+static void eager(const double *x, const double *y, double *z, size_t size) {
+	for (size_t i=0; i<size; i++) z[i] = op::apply(x[i], y[i]);
+}
+
+/**
+ * ns per element of x = a + b - c + d*0.5 - e and of x += a - b on n x m
+ * matrices, once with a temporary per operator and once as expressions.
+ * The temporaries are allocated once and reused, as stack temporaries would
+ * be, so only the extra passes are timed.
+ */
+template<int n, int m>
+static void matrix_rate() {
+	typedef mat<double, n, m> M;
+	const size_t size = size_t(n)*m;
+	const int repeats = max<size_t>(1, 50000000/size);
+	mt19937 rng(321);
+	uniform_real_distribution<double> d(-1, 1);
+	unique_ptr<M> a(new M), b(new M), c(new M), dd(new M), e(new M), x(new M), y(new M);
+	for (M *p : {a.get(), b.get(), c.get(), dd.get(), e.get()})
+		for (int i=0; i<n; i++) for (int j=0; j<m; j++) (*p)[i][j] = d(rng);
+	vector<double> t1(size), t2(size), t3(size), t4(size), t5(size);
+	double temps = seconds([&]{
+		for (int r=0; r<repeats; r++) {
+			eager<add_op>((*a)[0], (*b)[0], t1.data(), size);
+			eager<sub_op>(t1.data(), (*c)[0], t2.data(), size);
+			for (size_t i=0; i<size; i++) t3[i] = dd->at(i)*0.5;
+			eager<add_op>(t2.data(), t3.data(), t4.data(), size);
+			eager<sub_op>(t4.data(), (*e)[0], t5.data(), size);
+			copy(t5.begin(), t5.end(), (*x)[0]);
+		}
+	});
+	double fused = seconds([&]{
+		for (int r=0; r<repeats; r++) *y = *a + *b - *c + *dd*0.5 - *e;
+	});
+	bool same = equal((*x)[0], (*x)[0]+size, (*y)[0]);
+	double temps_add = seconds([&]{
+		for (int r=0; r<repeats; r++) {
+			eager<sub_op>((*a)[0], (*b)[0], t1.data(), size);
+			eager<add_op>((*x)[0], t1.data(), (*x)[0], size);
+		}
+	});
+	double fused_add = seconds([&]{
+		for (int r=0; r<repeats; r++) *y += *a - *b;
+	});
+	same = same && equal((*x)[0], (*x)[0]+size, (*y)[0]);
+	failures += !same;
+	double elements = double(size)*repeats;
+	printf("  %4dx%-6d %-22s %12.3f %10.3f\n", n, m, "x = a+b-c+d*0.5-e", temps*1e9/elements, fused*1e9/elements);
+	printf("  %4dx%-6d %-22s %12.3f %10.3f  %s\n", n, m, "x += a-b", temps_add*1e9/elements, fused_add*1e9/elements,
+			same ? "same" : "DIFFERENT");
+}
+
+/**
+ * The vec operator+ and operator- as they used to be, returning a new vector.
+ */
+static vec<double> old_add(const vec<double> &x, const vec<double> &y) {
+	vec<double> z(0,0,0,0);
+	for (int i=0; i<4; i++) z[i] = x[i]+y[i];
+	return z;
+}
+static vec<double> old_sub(const vec<double> &x, const vec<double> &y) {
+	vec<double> z(0,0,0,0);
+	for (int i=0; i<4; i++) z[i] = x[i]-y[i];
+	return z;
+}
+static vec<double> old_scale(vec<double> x, double s) {
+	for (int i=0; i<4; i++) x[i] = x[i]*s;
+	return x;
+}
+
+/**
+ * ns per vector of out[i] = a[i] + b[i] - c[i]*0.5 - d[i] over arrays of
+ * 10^6 vec, through the old by-value operators and as expressions.
+ */
+static void vector_rate() {
+	const size_t count = 1000000;
+	const int repeats = 20;
+	mt19937 rng(321);
+	uniform_real_distribution<double> d(-1, 1);
+	vector<vec<double>> a(count), b(count), c(count), dd(count), x(count), y(count);
+	for (vector<vec<double>> *p : {&a, &b, &c, &dd})
+		for (vec<double> &v : *p) v = vec<double>(d(rng), d(rng), d(rng), d(rng));
+	double temps = seconds([&]{
+		for (int r=0; r<repeats; r++)
+			for (size_t i=0; i<count; i++) x[i] = old_sub(old_sub(old_add(a[i], b[i]), old_scale(c[i], 0.5)), dd[i]);
+	});
+	double fused = seconds([&]{
+		for (int r=0; r<repeats; r++)
+			for (size_t i=0; i<count; i++) y[i] = a[i] + b[i] - c[i]*0.5 - dd[i];
+	});
+	bool same = true;
+	for (size_t i=0; i<count; i++) for (int j=0; j<4; j++) same = same && x[i][j]==y[i][j];
+	failures += !same;
+	printf("  %-11s %-22s %12.3f %10.3f  %s\n", "vec[10^6]", "a+b-c*0.5-d", temps*1e9/count/repeats, fused*1e9/count/repeats,
+			same ? "same" : "DIFFERENT");
+}
+
+/**
+ * Element-wise expressions against a temporary per operator, on a small
+ * matrix that is not 4x4, one that fits in cache, one that does not, and
+ * arrays of vec.
+ */
+static void expressions() {
+	printf("expressions: ns per element (per vector for vec)\n");
+	printf("  %-11s %-22s %12s %10s\n", "shape", "", "temporaries", "fused");
+	matrix_rate<3, 5>();
+	matrix_rate<64, 64>();
+	matrix_rate<1000, 1000>();
+	vector_rate();
+}
+
+int main(int argc, char **argv) {
+	struct {
+		const char *name;
+		void (*run)();
+	} sections[] = {
+		{"transform", transforming},
+		{"multiply", multiplying},
+		{"expressions", expressions},
+	};
+	vector<string> names(argv+1, argv+argc);
+	for (auto &s : sections)
+		if (names.empty() || find(names.begin(), names.end(), s.name)!=names.end()) s.run();
+	if (failures) fprintf(stderr, "%d check(s) failed\n", failures);
+	return failures ? 1 : 0;
+}
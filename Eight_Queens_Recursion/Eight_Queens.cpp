@@ -6,6 +6,8 @@
 // Description : Pretty-printer for Eight Queens
 //============================================================================
 #include "Eight_Queens.h"
+#include <cstdio>
+#include <cstring>
 #include <iostream>
 using namespace std;
 
@@ -56,9 +58,35 @@ static void print(unsigned long long int n) {
 }
 
 /**
- * Print all 92 solutions of the Eight Queens problem
+ * Print all 92 solutions of the Eight Queens problem.
+ * With -c only count them; with -x file or -b file stream the boards to file
+ * in hex (one per line) or binary (8 bytes each, least significant first).
  */
-int main() {
+int main(int argc, char **argv) {
+	if (argc==2 && !strcmp(argv[1], "-c")) {
+		cout << p03::count() << " solutions" << endl;
+		return 0;
+	}
+	if (argc==3 && (!strcmp(argv[1], "-x") || !strcmp(argv[1], "-b"))) {
+		FILE *out = fopen(argv[2], argv[1][1]=='b' ? "wb" : "w");
+		if (!out) {
+			perror(argv[2]);
+			return 1;
+		}
+		unsigned long long boards;
+		{
+			board_stream stream(out, argv[1][1]=='b' ? board_stream::binary : board_stream::hex);
+			p03::queens(stream);
+			boards = stream.boards();
+		}
+		fclose(out);
+		cout << boards << " boards written to " << argv[2] << endl;
+		return 0;
+	}
+	if (argc>1) {
+		cerr << "usage: " << argv[0] << " [-c | -x file | -b file]" << endl;
+		return 1;
+	}
 #ifndef USE_ASCII
 	setlocale(LC_ALL, "en_US.UTF-8"); // enable wide characters
 #endif
@@ -5,6 +5,16 @@
  *      Author: Matthew Brown
  */
 
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
 /**
  * Class to deal with solving the 8 queens problem.
  * Uses a recursive function to solve for all 92 solutions.
@@ -52,10 +62,11 @@ public:
 
 	/**
 	 * Recursively solves the 8 queens problem
-	 * @param f function passed from main to print out solutions
+	 * @param f function or other callable passed from main to print out solutions
 	 * @param row the current row that the algorithm is analyzing
 	 */
-	void putQueen(void (*f)(unsigned long long int), int row){
+	template<typename fn>
+	void putQueen(fn &f, int row){
 		for (int col=0; col<8; col++){			// iterate through each column in the row
 			if(checkQueen(row, col)){			// check to see if there are collisions with other queens
 				setQueen(row,col);				// set queen for the current row and column position
@@ -72,13 +83,836 @@ public:
 
 	/**
 	 * creates a p03 object to call the putQueen function and recursively solve the 8 queens problem.
-	 * Pre: Calling object to pass it a function function.
+	 * Pre: Calling object to pass it a function, or any callable taking the board; a lambda is inlined.
 	 * Post: Prints out the 92 solutions to the 8 Queens problem.
 	 */
-	static void queens(void (*f)(unsigned long long int)) {
+	template<typename fn>
+	static void queens(fn &&f) {
 		p03 board;
 		int row=0;
 		//const static unsigned long long int n = 0x0820800240010410ULL; // a sample solution: board 585608698710262800
 		board.putQueen(f,row);
 	}
+
+	/**
+	 * Counts the solutions without doing anything with them.
+	 * @return 92
+	 */
+	static unsigned long long count() {
+		unsigned long long found = 0;
+		queens([&](unsigned long long){ found++; });
+		return found;
+	}
 };
+
+/**
+ * Buffered output of 64-bit boards to a file, for passing to p03::queens in
+ * place of a printing function. Boards collect in a 64 KB buffer that goes
+ * to the file in one fwrite when full, rather than a formatted write and a
+ * flush per board.
+ */
+class board_stream {
+public:
+	enum format {
+		binary,		// 8 bytes per board, least significant first
+		hex			// 16 hex digits and a newline per board
+	};
+	/**
+	 * streams to out, which stays open, in the given format
+	 */
+	board_stream(std::FILE *out, format how) : out(out), how(how), used(0), written(0){}
+	/**
+	 * writes what is still buffered
+	 */
+	~board_stream() {
+		flush();
+	}
+	board_stream(const board_stream&) = delete;
+	board_stream& operator=(const board_stream&) = delete;
+	/**
+	 * adds board n to the stream
+	 */
+	void operator()(unsigned long long n) {
+		if (used+17>sizeof buffer) flush();
+		if (how==binary)
+			for (int i=0; i<8; i++) buffer[used++] = char(n>>8*i);
+		else {
+			static const char digit[] = "0123456789abcdef";
+			for (int i=60; i>=0; i-=4) buffer[used++] = digit[n>>i & 0xF];
+			buffer[used++] = '\n';
+		}
+		written++;
+	}
+	/**
+	 * hands the buffered boards to the file
+	 */
+	void flush() {
+		std::fwrite(buffer, 1, used, out);
+		used = 0;
+	}
+	/**
+	 * number of boards streamed
+	 */
+	unsigned long long boards() const {
+		return written;
+	}
+private:
+	std::FILE *out;
+	format how;
+	char buffer[1<<16];
+	std::size_t used;
+	unsigned long long written;
+};
+
+
+template<typename Task>
+/**
+ * Work-stealing task queues, one per worker. A worker takes from the back of
+ * its own queue, and when that is empty steals from the front of the others,
+ * so whoever finishes early picks up the larger, older tasks of the rest.
+ */
+class work_stealing {
+public:
+	/**
+	 * deals tasks round robin to the queues of the given number of workers
+	 */
+	work_stealing(const std::vector<Task> &tasks, unsigned workers) {
+		for (unsigned w=0; w<workers; w++) lanes.emplace_back(new lane);
+		for (std::size_t i=0; i<tasks.size(); i++) lanes[i%workers]->q.push_back(tasks[i]);
+	}
+	/**
+	 * gives worker the next task, its own or stolen
+	 * @return false when every queue is empty
+	 */
+	bool next(unsigned worker, Task &t) {
+		for (unsigned i=0; i<lanes.size(); i++) {
+			lane &l = *lanes[(worker+i)%lanes.size()];
+			std::lock_guard<std::mutex> lock(l.m);
+			if (l.q.empty()) continue;
+			if (i==0) {
+				t = l.q.back();
+				l.q.pop_back();
+			}
+			else {
+				t = l.q.front();
+				l.q.pop_front();
+			}
+			return true;
+		}
+		return false;
+	}
+	template<typename fn>
+	/**
+	 * runs work(worker) on the calling thread as worker 0 and on a new thread for each other worker, and waits for them
+	 */
+	void run(fn work) {
+		std::vector<std::thread> threads;
+		for (unsigned w=1; w<lanes.size(); w++) threads.emplace_back(work, w);
+		work(0u);
+		for (std::thread &t : threads) t.join();
+	}
+private:
+	struct lane {
+		std::mutex m;
+		std::deque<Task> q;
+	};
+	std::vector<std::unique_ptr<lane>> lanes;
+};
+
+/**
+ * N-Queens engine for boards from 1x1 up to 32x32.
+ * The squares still open in a row come from three masks carried down the
+ * recursion: the columns taken, and the diagonals and anti-diagonals
+ * attacked, shifted one place per row. So each row costs O(1) to set up,
+ * and the candidates are taken lowest bit first with x & -x, instead of
+ * checking every column against every earlier queen.
+ * Rows are reported as one-hot column masks, bit c meaning column c.
+ */
+class nqueens {
+public:
+	/**
+	 * engine for the n x n board (1 <= n <= 32)
+	 */
+	explicit nqueens(int n) : n(n), full(n>=32 ? ~std::uint32_t(0) : (std::uint32_t(1)<<n)-1) {}
+	/**
+	 * calls f(rows) for each solution, rows[r] being the mask of the queen in row r.
+	 * Solutions come in the order p03::putQueen finds them: columns tried lowest first, row by row.
+	 */
+	template<typename fn>
+	void solve(fn f) {
+		place(0, 0, 0, 0, f);
+	}
+	/**
+	 * number of solutions, without visiting them one by one on the last row
+	 */
+	unsigned long long count() const {
+		return n==1 ? 1 : count(0, 0, 0, 0);
+	}
+	/**
+	 * A partial board: queens in the first row rows, and the masks they leave for the next row.
+	 */
+	struct task {
+		int row;
+		std::uint32_t cols, left, right;
+		std::uint32_t rows[32];
+	};
+	/**
+	 * every partial board with the first depth rows filled (fewer if the board is smaller)
+	 */
+	std::vector<task> split(int depth) const {
+		std::vector<task> level(1, root());
+		for (depth = std::min(depth, n); level.size() && level[0].row<depth;) {
+			std::vector<task> next;
+			for (const task &t : level)
+				for (std::uint32_t open = full & ~(t.cols|t.left|t.right); open; open &= open-1) next.push_back(child(t, open & (0u-open)));
+			level.swap(next);
+		}
+		return level;
+	}
+	/**
+	 * number of solutions, splitting the search at depth rows into tasks for a work-stealing pool
+	 * @param threads threads to search with (0 means one per hardware thread)
+	 */
+	unsigned long long count_parallel(unsigned threads = 0, int depth = 3) const {
+		work_stealing<task> pool(split(depth), workers(threads));
+		std::vector<unsigned long long> found(workers(threads), 0);
+		pool.run([&](unsigned w){
+			task t;
+			while (pool.next(w, t)) found[w] += count_from(t);
+		});
+		unsigned long long total = 0;
+		for (unsigned long long f : found) total += f;
+		return total;
+	}
+	/**
+	 * calls f(rows) for each solution like solve, searching on several threads.
+	 * The calls are made one at a time, under a lock, in no particular order.
+	 * @param threads threads to search with (0 means one per hardware thread)
+	 */
+	template<typename fn>
+	void solve_parallel(fn f, unsigned threads = 0, int depth = 3) const {
+		work_stealing<task> pool(split(depth), workers(threads));
+		std::mutex m;
+		auto report = [&](const std::uint32_t *rows){
+			std::lock_guard<std::mutex> lock(m);
+			f(rows);
+		};
+		pool.run([&](unsigned w){
+			nqueens local(n);
+			task t;
+			while (pool.next(w, t)) local.solve_from(t, report);
+		});
+	}
+	/**
+	 * number of solutions, searching only the boards whose first queen is in
+	 * the left half and doubling, since mirroring a solution gives one with
+	 * the first queen in the right half. On odd boards a first queen in the
+	 * middle column is kept to the boards whose second queen is in the left half.
+	 */
+	unsigned long long count_symmetric() const {
+		if (n==1) return 1;
+		unsigned long long total = 0;
+		std::uint32_t left_half = (std::uint32_t(1)<<n/2)-1;
+		task start = root();
+		for (std::uint32_t open = left_half; open; open &= open-1) total += 2*count_from(child(start, open & (0u-open)));
+		if (n&1) {
+			task middle = child(start, std::uint32_t(1)<<n/2);
+			for (std::uint32_t open = left_half & ~(middle.cols|middle.left|middle.right); open; open &= open-1)
+				total += 2*count_from(child(middle, open & (0u-open)));
+		}
+		return total;
+	}
+	/**
+	 * calls f(rows) once for each fundamental solution, the one of its (up to 8)
+	 * rotations and reflections whose columns read smallest from the top row.
+	 * Only boards whose first queen is in the left half, or the middle column, are searched.
+	 * @param expand if true, f is called instead for every distinct rotation and reflection
+	 * of each fundamental solution, so for all solutions
+	 */
+	template<typename fn>
+	void fundamental(fn f, bool expand = false) {
+		std::uint32_t image[8][32], mask[32];
+		auto check = [&](const std::uint32_t *rows){
+			int k = symmetries(rows, image);
+			for (int i=1; i<k; i++)
+				if (std::lexicographical_compare(image[i], image[i]+n, image[0], image[0]+n)) return;
+			for (int i=0; i<(expand ? k : 1); i++) {
+				for (int r=0; r<n; r++) mask[r] = std::uint32_t(1)<<image[i][r];
+				f(static_cast<const std::uint32_t*>(mask));
+			}
+		};
+		task start = root();
+		for (std::uint32_t open = (std::uint32_t(1)<<(n+1)/2)-1; open; open &= open-1) solve_from(child(start, open & (0u-open)), check);
+	}
+	/**
+	 * the smallest of the 8 rotations and reflections of an 8x8 board packed as p03 packs it,
+	 * comparing row 0 first so it agrees with fundamental. Only bit twiddling: rows flip with a
+	 * byte swap, columns with a bit reversal inside each byte, and the transpose by delta swaps.
+	 */
+	static unsigned long long canonical(unsigned long long b) {
+		auto mirror = [](unsigned long long x){
+			x = (x>>1 & 0x5555555555555555ULL) | (x & 0x5555555555555555ULL)<<1;
+			x = (x>>2 & 0x3333333333333333ULL) | (x & 0x3333333333333333ULL)<<2;
+			return (x>>4 & 0x0F0F0F0F0F0F0F0FULL) | (x & 0x0F0F0F0F0F0F0F0FULL)<<4;
+		};
+		auto transpose = [](unsigned long long x){
+			unsigned long long t;
+			t = 0x0F0F0F0F00000000ULL & (x ^ x<<28); x ^= t ^ t>>28;
+			t = 0x3333000033330000ULL & (x ^ x<<14); x ^= t ^ t>>14;
+			t = 0x5500550055005500ULL & (x ^ x<<7);  x ^= t ^ t>>7;
+			return x;
+		};
+		unsigned long long best = b;
+		for (int i=0; i<8; i++) {
+			unsigned long long x = i&4 ? transpose(b) : b;
+			if (i&1) x = mirror(x);
+			if (i&2) x = __builtin_bswap64(x);
+			if (__builtin_bswap64(x)<__builtin_bswap64(best)) best = x;
+		}
+		return best;
+	}
+	/**
+	 * packs the rows of a board up to 8x8 into 64 bits the way p03 does, row r at bits 8r .. 8r+7
+	 */
+	static unsigned long long board(const std::uint32_t *rows, int n) {
+		unsigned long long b = 0;
+		for (int r=0; r<n; r++) b |= (unsigned long long)rows[r]<<8*r;
+		return b;
+	}
+private:
+	int n;
+	std::uint32_t full;			// the n columns
+	std::uint32_t rows[32];		// queen placed in each row so far
+
+	/**
+	 * the empty board
+	 */
+	static task root() {
+		task t;
+		t.row = 0;
+		t.cols = t.left = t.right = 0;
+		return t;
+	}
+	/**
+	 * t with a queen in column bit of its next row
+	 */
+	static task child(const task &t, std::uint32_t bit) {
+		task c = t;
+		c.rows[c.row++] = bit;
+		c.cols |= bit;
+		c.left = (t.left|bit)<<1;
+		c.right = (t.right|bit)>>1;
+		return c;
+	}
+	/**
+	 * writes the column of each row for every distinct rotation and reflection of a solution,
+	 * the solution itself first
+	 * @return how many distinct ones there are: 1, 2, 4 or 8
+	 */
+	int symmetries(const std::uint32_t *rows, std::uint32_t image[8][32]) const {
+		const int m = n-1;
+		for (int r=0; r<n; r++) {
+			int c = __builtin_ctz(rows[r]);
+			int to[8][2] = {{r, c}, {r, m-c}, {m-r, c}, {m-r, m-c}, {c, r}, {c, m-r}, {m-c, r}, {m-c, m-r}};
+			for (int i=0; i<8; i++) image[i][to[i][0]] = to[i][1];
+		}
+		int k = 1;
+		for (int i=1; i<8; i++) {
+			bool seen = false;
+			for (int j=0; j<k && !seen; j++) seen = std::equal(image[i], image[i]+n, image[j]);
+			if (!seen) std::copy(image[i], image[i]+n, image[k++]);
+		}
+		return k;
+	}
+	static unsigned workers(unsigned threads) {
+		return threads ? threads : std::max(1u, std::thread::hardware_concurrency());
+	}
+	/**
+	 * calls f(rows) for each solution that extends t
+	 */
+	template<typename fn>
+	void solve_from(const task &t, fn &f) {
+		std::copy(t.rows, t.rows+t.row, rows);
+		if (t.row==n) f(static_cast<const std::uint32_t*>(rows));
+		else place(t.row, t.cols, t.left, t.right, f);
+	}
+	/**
+	 * number of solutions that extend t
+	 */
+	unsigned long long count_from(const task &t) const {
+		if (t.row==n) return 1;
+		if (t.row+1==n) return __builtin_popcount(full & ~(t.cols|t.left|t.right));
+		return count(t.row, t.cols, t.left, t.right);
+	}
+	template<typename fn>
+	void place(int row, std::uint32_t cols, std::uint32_t left, std::uint32_t right, fn &f) {
+		std::uint32_t open = full & ~(cols|left|right);
+		while (open) {
+			std::uint32_t bit = open & (0u-open);		// lowest open column
+			open ^= bit;
+			rows[row] = bit;
+			if (row+1==n) f(static_cast<const std::uint32_t*>(rows));
+			else place(row+1, cols|bit, (left|bit)<<1, (right|bit)>>1, f);
+		}
+	}
+	unsigned long long count(int row, std::uint32_t cols, std::uint32_t left, std::uint32_t right) const {
+		std::uint32_t open = full & ~(cols|left|right);
+		if (row+2==n) {			// each open square here leaves the last row a popcount away
+			unsigned long long total = 0;
+			while (open) {
+				std::uint32_t bit = open & (0u-open);
+				open ^= bit;
+				total += __builtin_popcount(full & ~(cols|bit|(left|bit)<<1|(right|bit)>>1));
+			}
+			return total;
+		}
+		unsigned long long total = 0;
+		while (open) {
+			std::uint32_t bit = open & (0u-open);
+			open ^= bit;
+			total += count(row+1, cols|bit, (left|bit)<<1, (right|bit)>>1);
+		}
+		return total;
+	}
+};
+
+/**
+ * Exact cover solver: dancing links running Knuth's Algorithm X without recursion.
+ * Columns 0 .. primary-1 must each be covered exactly once; the secondary
+ * columns after them at most once. Every choice is made on the primary
+ * column with the fewest rows left, and undone by relinking the nodes.
+ */
+class exact_cover {
+public:
+	/**
+	 * empty matrix with the given numbers of primary and secondary columns
+	 */
+	exact_cover(int primary, int secondary = 0) : columns(primary+secondary), size(primary+secondary, 0) {
+		const int root = columns;
+		for (int c=0; c<=columns; c++) node(c, c, c, c, c, c);	// node c is column c's header, node columns the root
+		int last = root;
+		for (int c=0; c<primary; c++) {		// only primary headers join the root's ring
+			R[last] = c;
+			L[c] = last;
+			last = c;
+		}
+		R[last] = root;
+		L[root] = last;
+	}
+	/**
+	 * adds a row covering the given columns, which must be distinct
+	 * @return the row's number, as passed to the search callback
+	 */
+	int add_row(const std::vector<int> &cols) {
+		int first = L.size(), row = rows++;
+		for (std::size_t i=0; i<cols.size(); i++) {
+			int c = cols[i], x = L.size();
+			node(x, i ? x-1 : x, first, U[c], c, c);
+			R[x-(i ? 1 : 0)] = x;
+			L[first] = x;
+			D[U[c]] = x;
+			U[c] = x;
+			size[c]++;
+			rowof.push_back(row);
+		}
+		return row;
+	}
+	/**
+	 * calls f(rows, k) for every exact cover, rows holding the k row numbers chosen
+	 * @return the number of covers
+	 */
+	template<typename fn>
+	unsigned long long search(fn f) {
+		std::vector<int> choice, chosen;
+		unsigned long long found = 0;
+		const int root = columns;
+		for (;;) {
+			// forward: cover the primary column with the fewest rows, or report a solution
+			int c = -1;
+			if (R[root]==root) {
+				for (int x : choice) chosen.push_back(rowof[x-columns-1]);
+				f(static_cast<const int*>(chosen.data()), int(chosen.size()));
+				chosen.clear();
+				found++;
+			}
+			else {
+				c = R[root];
+				for (int j=R[c]; j!=root; j=R[j]) if (size[j]<size[c]) c = j;
+				cover(c);
+				choice.push_back(D[c]);
+			}
+			// try the next row of the current column, backing up past exhausted ones
+			for (;;) {
+				if (c<0) {
+					if (choice.empty()) return found;
+					int r = choice.back();
+					for (int j=L[r]; j!=r; j=L[j]) uncover(C[j]);
+					choice.back() = D[r];
+					c = C[r];
+				}
+				int r = choice.back();
+				if (r==c) {			// no rows left in c
+					uncover(c);
+					choice.pop_back();
+					c = -1;
+					continue;
+				}
+				for (int j=R[r]; j!=r; j=R[j]) cover(C[j]);
+				break;
+			}
+		}
+	}
+	/**
+	 * number of exact covers
+	 */
+	unsigned long long count() {
+		return search([](const int*, int){});
+	}
+private:
+	int columns, rows = 0;
+	std::vector<int> size;			// rows left in each column
+	std::vector<int> L, R, U, D, C;	// links of every node: headers 0 .. columns-1, the root, then the 1s of the rows
+	std::vector<int> rowof;			// row of each node after the root
+
+	void node(int x, int l, int r, int u, int d, int c) {
+		if (std::size_t(x)>=L.size()) {
+			L.resize(x+1);
+			R.resize(x+1);
+			U.resize(x+1);
+			D.resize(x+1);
+			C.resize(x+1);
+		}
+		L[x] = l;
+		R[x] = r;
+		U[x] = u;
+		D[x] = d;
+		C[x] = c;
+	}
+	void cover(int c) {
+		R[L[c]] = R[c];
+		L[R[c]] = L[c];
+		for (int i=D[c]; i!=c; i=D[i])
+			for (int j=R[i]; j!=i; j=R[j]) {
+				D[U[j]] = D[j];
+				U[D[j]] = U[j];
+				size[C[j]]--;
+			}
+	}
+	void uncover(int c) {
+		for (int i=U[c]; i!=c; i=U[i])
+			for (int j=L[i]; j!=i; j=L[j]) {
+				size[C[j]]++;
+				D[U[j]] = j;
+				U[D[j]] = j;
+			}
+		R[L[c]] = c;
+		L[R[c]] = c;
+	}
+};
+
+/**
+ * N-Queens as exact cover: a row per square, covering its rank and file
+ * (primary, so every rank and file gets a queen) and its two diagonals
+ * (secondary, so none gets two). Row r*n+c is the square in rank r, file c.
+ */
+inline exact_cover queens_cover(int n) {
+	exact_cover x(2*n, 2*(2*n-1));
+	for (int r=0; r<n; r++)
+		for (int c=0; c<n; c++) x.add_row({r, n+c, 2*n+r+c, 2*n+(2*n-1)+r-c+n-1});
+	return x;
+}
+
+/**
+ * Bitboard backtracking for placement puzzles on up to 64 squares: stage s
+ * places one piece on a square of allowed[s] that no earlier piece rules
+ * out, each piece on square q ruling out conflict[q]. The search is
+ * iterative, one open-square mask per stage, with candidates taken lowest
+ * bit first. Rules beyond masks plug in as a check on each placement.
+ */
+class bitboard_search {
+public:
+	/**
+	 * @param allowed squares each stage may use; its size is the number of pieces
+	 * @param conflict squares ruled out by a piece on each square, itself included
+	 * @param ordered if true, each piece goes above the square of the one before,
+	 * so placements of interchangeable pieces are found once rather than in every order
+	 */
+	bitboard_search(const std::vector<std::uint64_t> &allowed, const std::vector<std::uint64_t> &conflict, bool ordered = false)
+		: allowed(allowed), conflict(conflict), ordered(ordered){}
+	/**
+	 * conflict masks for a width x height board from a rule: attacks(r1, c1, r2, c2) tells
+	 * whether pieces on those squares clash. Square q is rank q / width, file q % width.
+	 */
+	template<typename rule>
+	static std::vector<std::uint64_t> conflicts(int width, int height, rule attacks) {
+		std::vector<std::uint64_t> conflict(width*height, 0);
+		for (int p=0; p<width*height; p++)
+			for (int q=0; q<width*height; q++)
+				if (p==q || attacks(p/width, p%width, q/width, q%width)) conflict[p] |= 1ULL<<q;
+		return conflict;
+	}
+	/**
+	 * calls f(squares, k) for each placement of all k pieces that check accepts
+	 * @param check check(squares, k) is asked about each partial placement of k pieces, the last one new
+	 * @return the number of placements
+	 */
+	template<typename fn, typename test>
+	unsigned long long search(fn f, test check) const {
+		const int stages = allowed.size();
+		if (!stages) return 0;
+		std::vector<std::uint64_t> open(stages), blocked(stages+1, 0);
+		std::vector<int> square(stages);
+		unsigned long long found = 0;
+		open[0] = allowed[0];
+		for (int level=0; level>=0;) {
+			if (!open[level]) {
+				level--;
+				continue;
+			}
+			std::uint64_t bit = open[level] & (0-open[level]);
+			open[level] ^= bit;
+			int q = __builtin_ctzll(bit);
+			square[level] = q;
+			if (!check(static_cast<const int*>(square.data()), level+1)) continue;
+			if (level+1==stages) {
+				f(static_cast<const int*>(square.data()), stages);
+				found++;
+				continue;
+			}
+			blocked[level+1] = blocked[level] | conflict[q];
+			std::uint64_t next = allowed[level+1] & ~blocked[level+1];
+			if (ordered) next &= ~((bit<<1)-1);
+			open[++level] = next;
+		}
+		return found;
+	}
+	/**
+	 * calls f(squares, k) for each placement, with no check beyond the masks
+	 */
+	template<typename fn>
+	unsigned long long search(fn f) const {
+		return search(f, [](const int*, int){ return true; });
+	}
+	/**
+	 * number of placements
+	 */
+	unsigned long long count() const {
+		return search([](const int*, int){});
+	}
+private:
+	std::vector<std::uint64_t> allowed, conflict;
+	bool ordered;
+};
+
+/**
+ * Min-conflicts local search for one N-Queens solution, for N far beyond
+ * what backtracking can reach (10^7 and more). Queens stay a permutation,
+ * one per row and column, so only diagonals can clash; the queens on each
+ * diagonal are counted in flat arrays. A greedy start puts all but a few
+ * queens on free diagonals, then queens still under attack are swapped with random
+ * rows whenever that lowers the number of attacking pairs. Both phases are
+ * near-linear in N. Random numbers come from xorshift64*.
+ */
+class min_conflicts {
+public:
+	/**
+	 * search for the n x n board, seeded with seed
+	 */
+	explicit min_conflicts(int n, std::uint64_t seed = 1) : n(n), state(seed ? seed : 1){}
+	/**
+	 * searches until every queen is safe, starting over if the repair stalls
+	 * @return false if the board has no solution (n = 2 or 3) or no squares (n < 1)
+	 */
+	bool solve() {
+		if (n<1 || n==2 || n==3) return false;
+		for (;;) {
+			start();
+			if (repair()) return true;
+		}
+	}
+	/**
+	 * column of the queen in each row, once solve has succeeded
+	 */
+	const std::vector<int> &columns() const {
+		return col;
+	}
+	/**
+	 * swaps made by the repair phase, over every restart
+	 */
+	long long swaps() const {
+		return swapped;
+	}
+	/**
+	 * checks the placement from scratch: one queen per column, none sharing a diagonal
+	 */
+	bool valid() const {
+		if (n<1 || int(col.size())!=n) return false;
+		std::vector<char> column(n, 0), down(2*n, 0), up(2*n, 0);
+		for (int r=0; r<n; r++) {
+			int c = col[r];
+			if (c<0 || c>=n || column[c]++ || down[r+c]++ || up[r-c+n]++) return false;
+		}
+		return true;
+	}
+private:
+	int n;
+	std::uint64_t state;
+	std::vector<int> col;			// column of the queen in each row
+	std::vector<int> down, up;		// queens on each diagonal (r+c) and anti-diagonal (r-c+n-1)
+	long long pairs = 0;			// attacking pairs
+	long long swapped = 0;
+
+	std::uint64_t next() {
+		state ^= state>>12;
+		state ^= state<<25;
+		state ^= state>>27;
+		return state*0x2545F4914F6CDD1DULL;
+	}
+	/**
+	 * uniform in [0, m), for m < 2^32
+	 */
+	int below(std::uint32_t m) {
+		return int((next()>>32)*m>>32);
+	}
+	/**
+	 * queens attacking the one in row r
+	 */
+	int attacks(int r) const {
+		return down[r+col[r]]+up[r-col[r]+n-1]-2;
+	}
+	void place(int r) {
+		pairs += down[r+col[r]]++ + up[r-col[r]+n-1]++;
+	}
+	void lift(int r) {
+		pairs -= --down[r+col[r]] + --up[r-col[r]+n-1];
+	}
+	/**
+	 * greedy start: fills rows in order, each with the first of up to 64 random
+	 * unused columns that lies on free diagonals, or the last one tried
+	 */
+	void start() {
+		col.resize(n);
+		for (int r=0; r<n; r++) col[r] = r;
+		down.assign(2*n-1, 0);
+		up.assign(2*n-1, 0);
+		pairs = 0;
+		for (int r=0; r<n; r++) {
+			int j = r;
+			for (int tries=0; tries<64; tries++) {
+				j = r+below(n-r);
+				if (!down[r+col[j]] && !up[r-col[j]+n-1]) break;
+			}
+			std::swap(col[r], col[j]);
+			place(r);
+		}
+	}
+	/**
+	 * swaps attacked queens with random rows while that lowers the attacking pairs
+	 * @return false if it stalls, with queens still attacked after many tries
+	 */
+	bool repair() {
+		std::vector<int> attacked;
+		for (int r=0; r<n; r++) if (attacks(r)) attacked.push_back(r);
+		long long budget = 20LL*n+100000;
+		while (pairs) {
+			if (attacked.empty())
+				for (int r=0; r<n; r++) if (attacks(r)) attacked.push_back(r);
+			std::size_t k = below(attacked.size());
+			int i = attacked[k];
+			if (!attacks(i)) {
+				attacked[k] = attacked.back();
+				attacked.pop_back();
+				continue;
+			}
+			if (--budget<0) return false;
+			int j = below(n);
+			if (j==i) continue;
+			long long before = pairs;
+			lift(i);
+			lift(j);
+			std::swap(col[i], col[j]);
+			place(i);
+			place(j);
+			if (pairs<before) {
+				swapped++;
+				if (attacks(j)) attacked.push_back(j);
+				continue;
+			}
+			lift(i);
+			lift(j);
+			std::swap(col[i], col[j]);
+			place(i);
+			place(j);
+		}
+		return true;
+	}
+};
+
+#if __cplusplus >= 201703L
+
+template<int N, typename fn>
+/**
+ * constexpr bitmask search of the N x N board: calls f(rows) for each
+ * solution, in p03's order, rows[r] being the mask of the queen in row r.
+ * Iterative, with the masks of each row kept in arrays, so it can run at
+ * compile time.
+ */
+constexpr void queens_walk(fn &&f) {
+	static_assert(N>=1 && N<=32, "boards from 1x1 to 32x32");
+	const std::uint32_t full = N>=32 ? ~std::uint32_t(0) : (std::uint32_t(1)<<N)-1;
+	std::uint32_t open[N] = {}, cols[N] = {}, left[N] = {}, right[N] = {}, rows[N] = {};
+	open[0] = full;
+	for (int row=0; row>=0;) {
+		if (!open[row]) {
+			row--;
+			continue;
+		}
+		std::uint32_t bit = open[row] & (0u-open[row]);
+		open[row] ^= bit;
+		rows[row] = bit;
+		if (row+1==N) {
+			f(static_cast<const std::uint32_t*>(rows));
+			continue;
+		}
+		cols[row+1] = cols[row]|bit;
+		left[row+1] = (left[row]|bit)<<1;
+		right[row+1] = (right[row]|bit)>>1;
+		row++;
+		open[row] = full & ~(cols[row]|left[row]|right[row]);
+	}
+}
+
+template<int N>
+/**
+ * number of solutions on the N x N board, usable at compile time for small N
+ */
+constexpr unsigned long long queens_count() {
+	unsigned long long found = 0;
+	queens_walk<N>([&](const std::uint32_t*){ found++; });
+	return found;
+}
+
+template<int N>
+/**
+ * every solution on the N x N board (N <= 8) packed as p03 packs boards, in p03's order, computed at compile time
+ */
+constexpr std::array<std::uint64_t, queens_count<N>()> queens_boards() {
+	static_assert(N<=8, "a board must fit in 64 bits");
+	std::array<std::uint64_t, queens_count<N>()> boards{};
+	std::size_t k = 0;
+	queens_walk<N>([&](const std::uint32_t *rows){
+		std::uint64_t b = 0;
+		for (int r=0; r<N; r++) b |= std::uint64_t(rows[r])<<8*r;
+		boards[k++] = b;
+	});
+	return boards;
+}
+
+/**
+ * The 92 solutions to the 8 queens problem as p03::queens produces them, built by the compiler.
+ */
+inline constexpr std::array<std::uint64_t, 92> eight_queens = queens_boards<8>();
+static_assert(queens_count<8>()==92, "the compile-time search must find all 92 boards");
+static_assert(eight_queens.front()==0x0802400420801001ULL, "first board is columns 0 4 7 5 2 6 1 3");
+static_assert(eight_queens.back()==0x1040022004010880ULL, "last board is columns 7 3 0 2 5 1 6 4");
+#endif
@@ -0,0 +1,299 @@
+//============================================================================
+// Name        : Eight_Queens_bench.cpp
+// Author      : Matthew Brown
+// Description : Timing runs for the p03 queens solvers
+//				 Build with: g++ -std=c++17 -O2 -march=native -pthread Eight_Queens_bench.cpp
+//				 Runs every section, or only the ones named: ./a.out bitmask
+//				 A number on the command line is the largest N to count (default 16)
+//============================================================================
+
+#include "Eight_Queens.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <locale>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+
+using namespace std;
+
+static int largest = 16;	// largest board the counting sections go up to
+static int failures = 0;	// checks that came out wrong; main exits non-zero if any did
+
+/**
+ * Seconds elapsed while running f once.
+ */
+template<typename fn>
+static double seconds(fn f) {
+	auto start = chrono::steady_clock::now();
+	f();
+	return chrono::duration<double>(chrono::steady_clock::now()-start).count();
+}
+
+static unsigned long long found;	// solutions seen by tally
+static void tally(unsigned long long) {
+	found++;
+}
+
+/**
+ * The 8x8 search of p03 against the bitmask engine, then the engine counting
+ * every board from 8x8 up to largest x largest.
+ */
+static void bitmask() {
+	const int repeats = 2000;
+	found = 0;
+	double old = seconds([]{ for (int i=0; i<repeats; i++) p03::queens(tally); });
+	unsigned long long each = 0;
+	double engine = seconds([&]{ for (int i=0; i<repeats; i++) nqueens(8).solve([&](const uint32_t*){ each++; }); });
+	printf("bitmask: N = 8, microseconds per full search\n");
+	printf("  %-22s %10.2f  (%llu solutions)\n", "p03::queens", old*1e6/repeats, found/repeats);
+	printf("  %-22s %10.2f  (%llu solutions)\n", "nqueens::solve", engine*1e6/repeats, each/repeats);
+	printf("  %4s %14s %12s\n", "N", "solutions", "seconds");
+	for (int n=8; n<=largest; n++) {
+		unsigned long long total = 0;
+		double s = seconds([&]{ total = nqueens(n).count(); });
+		printf("  %4d %14llu %12.4f\n", n, total, s);
+	}
+}
+
+/**
+ * Strong scaling of count_parallel from one thread to all of them, on the
+ * three largest boards up to largest, split into tasks 3 rows deep.
+ */
+static void parallel() {
+	unsigned most = max(1u, thread::hardware_concurrency());
+	printf("parallel: seconds (speedup over 1 thread), split at depth 3\n");
+	printf("  %4s %14s", "N", "solutions");
+	for (unsigned t=1; t<=most; t = t<most && 2*t>most ? most : 2*t) printf(" %7u thread%s  ", t, t>1 ? "s" : " ");
+	printf("\n");
+	for (int n=max(8, largest-2); n<=largest; n++) {
+		unsigned long long total = 0;
+		double one = 0;
+		for (unsigned t=1; t<=most; t = t<most && 2*t>most ? most : 2*t) {
+			double s = seconds([&]{ total = nqueens(n).count_parallel(t, 3); });
+			if (t==1) {
+				one = s;
+				printf("  %4d %14llu", n, total);
+			}
+			printf(" %8.3f (%4.1fx)", s, one/s);
+		}
+		printf("\n");
+	}
+}
+
+/**
+ * Full search against the symmetry-reduced one, counting and enumerating,
+ * for N = 8 up to two below largest. The fundamental solutions are checked
+ * against their known counts from N = 1, and at N = 8 against canonical
+ * applied to all 92 boards.
+ */
+static void symmetry() {
+	static const unsigned long long known[] = {1, 0, 0, 1, 2, 1, 6, 12, 46, 92, 341, 1787, 9233, 45752, 285053, 1846955, 11977939};	// by N from 1
+	const int listed = sizeof known/sizeof *known;
+	auto fundamentals = [](int n){
+		unsigned long long k = 0;
+		nqueens(n).fundamental([&](const uint32_t*){ k++; });
+		return k;
+	};
+	for (int n=1; n<8; n++)
+		if (fundamentals(n)!=known[n-1]) {
+			printf("symmetry: %llu fundamental solutions for N = %d, not %llu  MISMATCH\n", fundamentals(n), n, known[n-1]);
+			failures++;
+		}
+	vector<unsigned long long> canon, fund;
+	nqueens(8).solve([&](const uint32_t *rows){ canon.push_back(nqueens::canonical(nqueens::board(rows, 8))); });
+	nqueens(8).fundamental([&](const uint32_t *rows){ fund.push_back(nqueens::board(rows, 8)); });
+	sort(canon.begin(), canon.end());
+	canon.erase(unique(canon.begin(), canon.end()), canon.end());
+	sort(fund.begin(), fund.end());
+	bool canonical = canon==fund;
+	failures += !canonical;
+	printf("symmetry: canonical over the 92 boards gives %zu boards, %s the %zu fundamental ones\n", canon.size(),
+			canonical ? "the same as" : "NOT the same as", fund.size());
+	printf("symmetry: seconds\n");
+	printf("  %4s %12s %10s %10s %12s %10s %10s\n", "N", "solutions", "count", "symmetric", "fundamentals", "solve", "fundamental");
+	for (int n=8; n<=max(8, largest-2); n++) {
+		unsigned long long total = 0, reduced = 0, fundamental = 0, visited = 0;
+		double full = seconds([&]{ total = nqueens(n).count(); });
+		double half = seconds([&]{ reduced = nqueens(n).count_symmetric(); });
+		double all = seconds([&]{ nqueens(n).solve([&](const uint32_t*){ visited++; }); });
+		double fund = seconds([&]{ nqueens(n).fundamental([&](const uint32_t*){ fundamental++; }); });
+		bool agree = total==reduced && total==visited && (n>listed || fundamental==known[n-1]);
+		failures += !agree;
+		printf("  %4d %12llu %10.4f %10.4f %12llu %10.4f %10.4f%s\n", n, total, full, half, fundamental, all, fund,
+				agree ? "" : "  MISMATCH");
+	}
+}
+
+/**
+ * The driver's print_board, aimed at any wide stream: one board, then a flush.
+ */
+static void pretty(wostream &out, unsigned long long n) {
+	out << endl << L"╭─────────────────╮" << endl << L"│ ";
+	for (unsigned long long bit = 1ULL << 63; bit; bit >>= 1) {
+		out << (bit & n ? L"♛" : L" ");
+		if (bit & 0x55AA55AA55AA55AAULL) out << L"\u20DE";
+		if (bit & 0x101010101010100ULL) out << L" │" << endl << L"│ ";
+		else out << L" ";
+	}
+	out << L"│  №" << n << endl << L"╰─────────────────╯";
+	out.flush();
+}
+
+/**
+ * End-to-end time of one run of the 8x8 search with each way of handling the
+ * boards: counting through the old function pointer interface and through an
+ * inlined lambda, streaming to a file in hex and binary, and pretty-printing
+ * to a file the way the driver prints to the terminal.
+ */
+static void output() {
+	const int repeats = 1000;
+	const char *path = "Eight_Queens_bench.out";
+	printf("output: microseconds per run of all 92 boards\n");
+	found = 0;
+	double pointer = seconds([]{ for (int i=0; i<repeats; i++) p03::queens(tally); });
+	unsigned long long counted = 0;
+	double inlined = seconds([&]{ for (int i=0; i<repeats; i++) counted += p03::count(); });
+	printf("  %-26s %10.2f  (%llu boards)\n", "count, function pointer", pointer*1e6/repeats, found/repeats);
+	printf("  %-26s %10.2f  (%llu boards)\n", "count, p03::count", inlined*1e6/repeats, counted/repeats);
+	for (board_stream::format how : {board_stream::hex, board_stream::binary}) {
+		FILE *out = fopen(path, "wb");
+		unsigned long long boards = 0;
+		double s = seconds([&]{
+			board_stream stream(out, how);
+			for (int i=0; i<repeats; i++) p03::queens(stream);
+			boards = stream.boards();
+		});
+		fclose(out);
+		printf("  %-26s %10.2f  (%llu boards)\n", how==board_stream::hex ? "board_stream, hex" : "board_stream, binary", s*1e6/repeats, boards/repeats);
+	}
+	{
+		wofstream out(path);
+		for (const char *name : {"en_US.UTF-8", "C.UTF-8"})	// the driver's locale, or the one every glibc has
+			try {
+				out.imbue(locale(name));
+				break;
+			}
+			catch (const runtime_error&) {}
+		unsigned long long boards = 0;
+		double s = seconds([&]{
+			for (int i=0; i<repeats; i++) p03::queens([&](unsigned long long n){ pretty(out, n); boards++; });
+		});
+		printf("  %-26s %10.2f  (%llu boards)%s\n", "pretty-printed, flushed", s*1e6/repeats, boards/repeats, out ? "" : "  (no UTF-8 locale, output failed)");
+	}
+	remove(path);
+}
+
+/**
+ * The general backtracking backends on N-Queens against the dedicated
+ * bitmask engine: dancing links on the exact cover form for N = 8 up to
+ * two below largest, and the bitboard search for the boards that fit in 64
+ * squares, each count checked against the engine's. Then the bitboard
+ * search on other pieces, through their rules.
+ */
+static void framework() {
+	printf("framework: N-Queens solutions / milliseconds\n");
+	printf("  %4s %20s %20s %20s\n", "N", "nqueens::count", "exact_cover", "bitboard_search");
+	auto queen = [](int r1, int c1, int r2, int c2){ return r1==r2 || c1==c2 || r1-c1==r2-c2 || r1+c1==r2+c2; };
+	for (int n=8; n<=max(8, largest-2); n++) {
+		unsigned long long bits = 0, cover = 0, board = 0;
+		double a = seconds([&]{ bits = nqueens(n).count(); });
+		double b = seconds([&]{ cover = queens_cover(n).count(); });
+		printf("  %4d %10llu %9.2f %10llu %9.2f", n, bits, a*1e3, cover, b*1e3);
+		if (n<=8) {
+			vector<uint64_t> ranks(n);
+			for (int r=0; r<n; r++) ranks[r] = ((1ULL<<n)-1)<<n*r;
+			double c = seconds([&]{ board = bitboard_search(ranks, bitboard_search::conflicts(n, n, queen)).count(); });
+			printf(" %10llu %9.2f", board, c*1e3);
+		}
+		bool agree = cover==bits && (n>8 || board==bits);
+		failures += !agree;
+		printf("%s\n", agree ? "" : "  MISMATCH");
+	}
+	vector<uint64_t> ranks(8), anywhere(8, (1ULL<<36)-1);
+	for (int r=0; r<8; r++) ranks[r] = 0xFFULL<<8*r;
+	auto rook = [](int r1, int c1, int r2, int c2){ return r1==r2 || c1==c2; };
+	auto knight = [](int r1, int c1, int r2, int c2){ int dr = abs(r1-r2), dc = abs(c1-c2); return (dr==1 && dc==2) || (dr==2 && dc==1); };
+	unsigned long long rooks = 0, knights = 0;
+	double r = seconds([&]{ rooks = bitboard_search(ranks, bitboard_search::conflicts(8, 8, rook)).count(); });
+	double k = seconds([&]{ knights = bitboard_search(anywhere, bitboard_search::conflicts(6, 6, knight), true).count(); });
+	printf("  8 rooks, one per rank: %llu in %.2f ms; 8 knights on 6x6: %llu in %.2f ms\n", rooks, r*1e3, knights, k*1e3);
+}
+
+/**
+ * The compile-time table of the 92 boards against the searches that build
+ * it at run time: checks they agree board for board, in order, and times
+ * getting all 92 each way.
+ */
+static void table() {
+	const int repeats = 2000;
+	vector<unsigned long long> runtime, engine;
+	p03::queens([&](unsigned long long n){ runtime.push_back(n); });
+	nqueens(8).solve([&](const uint32_t *rows){ engine.push_back(nqueens::board(rows, 8)); });
+	bool same = runtime.size()==eight_queens.size() && equal(runtime.begin(), runtime.end(), eight_queens.begin())
+			&& engine==runtime;
+	failures += !same;
+	printf("table: compile-time eight_queens %s the run-time searches\n", same ? "matches" : "DOES NOT MATCH");
+	unsigned long long sink = 0;
+	double old = seconds([&]{ for (int i=0; i<repeats; i++) p03::queens([&](unsigned long long n){ sink += n; }); });
+	double bits = seconds([&]{ for (int i=0; i<repeats; i++) nqueens(8).solve([&](const uint32_t *rows){ sink += nqueens::board(rows, 8); }); });
+	double fixed = seconds([&]{
+		for (int i=0; i<repeats; i++) {
+			for (unsigned long long n : eight_queens) sink += n;
+			asm volatile("" : "+r"(sink));	// keep the loop from being folded away
+		}
+	});
+	printf("  %-22s %10.3f us\n", "p03::queens", old*1e6/repeats);
+	printf("  %-22s %10.3f us\n", "nqueens::solve", bits*1e6/repeats);
+	printf("  %-22s %10.3f us  (checksum %llu)\n", "eight_queens table", fixed*1e6/repeats, sink);
+}
+
+/**
+ * Time to one solution with the min-conflicts search, from 1000 queens up
+ * by tenfolds to 10^7, stopping early where a run would not fit in a
+ * quarter of physical memory (about 20 bytes a queen).
+ */
+static void local() {
+	double memory = double(sysconf(_SC_PHYS_PAGES))*sysconf(_SC_PAGESIZE);
+	printf("local: min-conflicts, time to one solution\n");
+	printf("  %10s %10s %8s %s\n", "n", "ms", "swaps", "check");
+	for (int n=1000; n<=10000000 && n*20.0<memory/4; n*=10) {
+		min_conflicts search(n);
+		bool solved = false;
+		double t = seconds([&]{ solved = search.solve(); });
+		bool ok = solved && search.valid();
+		failures += !ok;
+		printf("  %10d %10.1f %8lld %s\n", n, t*1e3, search.swaps(), ok ? "ok" : "FAILED");
+	}
+}
+
+int main(int argc, char **argv) {
+	struct {
+		const char *name;
+		void (*run)();
+	} sections[] = {
+		{"bitmask", bitmask},
+		{"parallel", parallel},
+		{"symmetry", symmetry},
+		{"output", output},
+		{"framework", framework},
+		{"table", table},
+		{"local", local},
+	};
+	vector<string> names;
+	for (int i=1; i<argc; i++) {
+		string arg = argv[i];
+		if (isdigit((unsigned char)arg[0])) largest = atoi(arg.c_str());
+		else names.push_back(arg);
+	}
+	for (auto &s : sections)
+		if (names.empty() || find(names.begin(), names.end(), s.name)!=names.end()) s.run();
+	if (failures) fprintf(stderr, "%d check(s) failed\n", failures);
+	return failures ? 1 : 0;
+}
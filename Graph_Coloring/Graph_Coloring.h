@@ -4,6 +4,243 @@
  * @author Matthew Brown
  */
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <istream>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+template<typename T, typename Hash = std::hash<T>>
+/**
+ * Interned vertex-id table: maps each distinct T to a dense id 0, 1, 2, ...
+ * in order of first appearance, with O(1) expected find and add.
+ * Each key is hashed once on the way in. The hash is kept beside the key, so
+ * probes compare hashes before keys and growing never hashes a key again.
+ */
+class vertex_ids {
+public:
+	/**
+	 * default constructor for an empty table
+	 */
+	vertex_ids() : shift(64-4), table(16, -1){}
+	/**
+	 * returns the id of a, or -1 if it has none
+	 */
+	int find(const T &a) const {
+		return table[probe(a, hash(a))];
+	}
+	/**
+	 * returns the id of a, giving it the next id if it has none yet
+	 */
+	int add(const T &a) {
+		std::size_t h = hash(a);
+		std::size_t i = probe(a, h);
+		if (table[i]>=0) return table[i];
+		if (2*(names.size()+1)>table.size()) {
+			grow();
+			i = probe(a, h);
+		}
+		table[i] = names.size();
+		names.push_back(a);
+		hashes.push_back(h);
+		return table[i];
+	}
+	/**
+	 * number of ids handed out
+	 */
+	int size() const {
+		return names.size();
+	}
+	/**
+	 * the key with the given id
+	 */
+	const T &operator[](int id) const {
+		return names[id];
+	}
+private:
+	std::vector<T> names;				// key of each id
+	std::vector<std::size_t> hashes;	// hash of each id's key
+	int shift;							// 64 - log2(table size)
+	std::vector<int> table;				// linear-probing table of ids, -1 when empty, at most half full
+	Hash hash;
+
+	/**
+	 * home slot of hash h, by Fibonacci hashing
+	 */
+	std::size_t slot(std::size_t h) const {
+		return (std::uint64_t(h)*0x9E3779B97F4A7C15ULL)>>shift;
+	}
+	/**
+	 * returns the slot holding a, or the empty slot where the probe for a stopped
+	 */
+	std::size_t probe(const T &a, std::size_t h) const {
+		std::size_t mask = table.size()-1, i = slot(h);
+		while (table[i]>=0 && !(hashes[table[i]]==h && names[table[i]]==a)) i = (i+1)&mask;
+		return i;
+	}
+	/**
+	 * doubles the table, placing every id again from its stored hash
+	 */
+	void grow() {
+		table.assign(2*table.size(), -1);
+		shift--;
+		std::size_t mask = table.size()-1;
+		for (std::size_t id=0; id<names.size(); id++) {
+			std::size_t i = slot(hashes[id]);
+			while (table[i]>=0) i = (i+1)&mask;
+			table[i] = id;
+		}
+	}
+};
+
+/**
+ * Greedy coloring engine: gives each vertex, in a given order, the smallest
+ * color that none of its already colored neighbours has.
+ * Runs in O(V + E): forbidden colors are stamped into a marker array that is
+ * reused from vertex to vertex (and from run to run) instead of being
+ * collected, sorted and freed for each vertex.
+ */
+class greedy_coloring {
+public:
+	/**
+	 * what run passes to neighbors: call it with each neighbour id to forbid that neighbour's color
+	 */
+	struct forbid {
+		greedy_coloring &g;
+		const int *color;
+		void operator()(int u) const {
+			g.exclude(color[u]);
+		}
+	};
+	/**
+	 * colors the n vertices in order.
+	 * @param neighbors neighbors(v, f) calls f(u) for every neighbour id u of v, f being a forbid
+	 * @param color color per vertex id, negative while uncolored; filled in for the vertices in order
+	 */
+	template<typename fn>
+	void run(const int *order, std::size_t n, fn neighbors, int *color) {
+		const forbid f{*this, color};
+		for (std::size_t i=0; i<n; i++) {
+			int v = order[i];
+			start();
+			neighbors(v, f);
+			color[v] = smallest();
+		}
+	}
+	/**
+	 * step 1 of coloring one vertex by hand: forget the colors excluded for the last one
+	 */
+	void start() {
+		if (++stamp==0) {	// wrapped around: old stamps could look current
+			std::fill(mark.begin(), mark.end(), 0u);
+			stamp = 1;
+		}
+	}
+	/**
+	 * step 2: rule out color c (ignored if negative, i.e. uncolored)
+	 */
+	void exclude(int c) {
+		if (c<0) return;
+		if (std::size_t(c)>=mark.size()) mark.resize(c+1, 0u);
+		mark[c] = stamp;
+	}
+	/**
+	 * step 3: the smallest color not ruled out since start
+	 */
+	int smallest() const {
+		std::size_t c = 0;
+		while (c<mark.size() && mark[c]==stamp) c++;
+		return c;
+	}
+private:
+	std::vector<unsigned> mark;	// mark[c]==stamp if color c is taken around the current vertex
+	unsigned stamp = 0;
+};
+
+template<typename fn>
+/**
+ * orders vertex ids by degree, largest first, keeping the given order among equal degrees.
+ * Counting sort, so O(V + max degree).
+ * @param degree degree(v) gives the degree of id v
+ */
+std::vector<int> largest_first(const std::vector<int> &ids, fn degree) {
+	int most = 0;
+	for (int v : ids) most = std::max(most, int(degree(v)));
+	std::vector<std::size_t> start(most+2, 0);	// start[most-d] is where degree d begins
+	for (int v : ids) start[most-degree(v)+1]++;
+	for (int d=0; d<=most; d++) start[d+1] += start[d];
+	std::vector<int> order(ids.size());
+	for (int v : ids) order[start[most-degree(v)]++] = v;
+	return order;
+}
+
+/**
+ * Bucket queue of vertex ids keyed by small integers, each bucket a doubly
+ * linked list threaded through arrays, so push, erase and changing a key
+ * are O(1). Callers track the lowest or highest nonempty bucket themselves.
+ */
+class bucket_queue {
+public:
+	/**
+	 * empty queue for ids 0..n-1 and keys 0..keys-1
+	 */
+	bucket_queue(int n, int keys) : head(keys, -1), next(n, -1), prev(n, -1), keyof(n, -1){}
+	/**
+	 * puts v, which must not be queued, at the front of bucket k
+	 */
+	void push(int v, int k) {
+		keyof[v] = k;
+		prev[v] = -1;
+		next[v] = head[k];
+		if (head[k]>=0) prev[head[k]] = v;
+		head[k] = v;
+	}
+	/**
+	 * takes v out of its bucket
+	 */
+	void erase(int v) {
+		(prev[v]>=0 ? next[prev[v]] : head[keyof[v]]) = next[v];
+		if (next[v]>=0) prev[next[v]] = prev[v];
+		keyof[v] = -1;
+	}
+	/**
+	 * moves v to the front of bucket k
+	 */
+	void move(int v, int k) {
+		erase(v);
+		push(v, k);
+	}
+	/**
+	 * key of v, or -1 if v is not queued
+	 */
+	int key(int v) const {
+		return keyof[v];
+	}
+	/**
+	 * first id in bucket k, or -1 if it is empty
+	 */
+	int front(int k) const {
+		return head[k];
+	}
+private:
+	std::vector<int> head, next, prev, keyof;
+};
+
 template<typename T>
 /**
  * graph class to store graph data.
@@ -15,21 +252,22 @@ public:
 	 */
 	struct node{
 		T data;
+		int id;			// interned id of data: the vertex's own id, or the neighbour's in an adjacency list
 		int degree;
 		int nodecolor;
 		node *next, *list;
 		/**
 		 * Default constructor for node
 		 */
-		node() : data(0), degree(0), nodecolor(-2), next(nullptr), list(nullptr){}
+		node() : data(0), id(-1), degree(0), nodecolor(-2), next(nullptr), list(nullptr){}
 		/**
 		 * overloaded constructor for node insertion at the end of a list.
 		 */
-		node(T data) : data(data), degree(0), nodecolor(-2), next(nullptr), list(nullptr) {}
+		node(T data, int id = -1) : data(data), id(id), degree(0), nodecolor(-2), next(nullptr), list(nullptr) {}
 		/**
 		 * Overloaded constructor for node insertion in the middle of the list
 		 */
-		node(T data, node* list): data(data), degree(0), nodecolor(-2), next(nullptr), list(list) {}
+		node(T data, int id, node* list): data(data), id(id), degree(0), nodecolor(-2), next(nullptr), list(list) {}
 	} *root = nullptr, *current = nullptr;
 	int vert;
 	int totaldegree;
@@ -39,42 +277,56 @@ public:
 	 */
 	graph() : vert(0), totaldegree(0), colored(nullptr){}
 	/**
-	 * Sort function to sort the vertices by degree
-	 */
-	void sort(node* &p){
-		if(!p) return;
-		else(sort(p->next));
-		if(!p->next) return;
-		else{
-			if(p->degree<p->next->degree){
-				node* temp = p;
-				p = p->next;
-				temp->next = p->next;
-				p->next = temp;
-				return;
+	 * move constructor: takes g's nodes and leaves g empty
+	 */
+	graph(graph &&g) : graph() {
+		swap(g);
+	}
+	/**
+	 * move assignment: takes g's nodes and frees the ones held before
+	 */
+	graph &operator=(graph &&g) {
+		graph doomed(std::move(*this));
+		swap(g);
+		return *this;
+	}
+	/**
+	 * a graph owns its nodes, so copies would free them twice
+	 */
+	graph(const graph &) = delete;
+	graph &operator=(const graph &) = delete;
+	/**
+	 * destructor frees every vertex node and adjacency list
+	 */
+	~graph() {
+		node* p = root;
+		while (p) {
+			node* listing = p->list;
+			while (listing) {
+				node* doomed = listing;
+				listing = listing->list;
+				delete doomed;
 			}
+			node* doomed = p;
+			p = p->next;
+			delete doomed;
 		}
-		return;
 	}
 	/**
-	 * Sorts list by alphabetical order
+	 * Sorts list by alphabetical order.
+	 * Relinks the nodes rather than swapping their data, so ids stay with their vertices.
 	 */
 	void sort2(node* &p){
-		bool swap = false;
-		node* head = p;
-		do{
-			swap = false;
-			while(p->next){
-				if(p->data>p->next->data){
-					T temp = p->data;
-					p->data = p->next->data;
-					p->next->data = temp;
-					swap = true;
-				}
-				p = p->next;
-			}
-			p = head;
-		}while(swap);
+		std::vector<node*> order;
+		for (node* trav = p; trav; trav = trav->next) order.push_back(trav);
+		std::stable_sort(order.begin(), order.end(), [](node* a, node* b){ return a->data<b->data; });
+		node** link = &p;
+		for (node* trav : order) {
+			*link = trav;
+			link = &trav->next;
+		}
+		*link = nullptr;
+		last = order.empty() ? nullptr : order.back();
 	}
 	/**
 	 * caller function for sort2
@@ -86,16 +338,57 @@ public:
 	 * public insert function
 	 */
     void ins(const T a, const T b) {
-    	ins(root,a,b);
-    	ins(root,b,a);
-    	sort(root);
+    	node* pa = add_vertex(a);
+    	node* pb = add_vertex(b);
+    	ins(pa, pb);
+    	ins(pb, pa);
     	return;
     }
+    /**
+     * returns the vertex node with the given interned id
+     */
+    node* vertex(int id) const {
+    	return byid[id];
+    }
+    /**
+     * returns the vertex node for a, or nullptr if a is not in the graph
+     */
+    node* find(const T &a) const {
+    	int id = ids.find(a);
+    	return id<0 ? nullptr : byid[id];
+    }
+    /**
+     * the vertex nodes sorted by data (ties in list order), without touching the list.
+     * O(V log V); take it once to walk the vertices in order many times.
+     */
+    std::vector<const node*> sorted() const {
+    	std::vector<const node*> order;
+    	order.reserve(vert);
+    	for (const node* p = root; p; p = p->next) order.push_back(p);
+    	std::stable_sort(order.begin(), order.end(), [](const node* a, const node* b){ return a->data<b->data; });
+    	return order;
+    }
+    template<typename fn>
+    /**
+     * calls f(name) for each vertex, in sorted order. Leaves the graph as it is.
+     */
+    void traverse_vertices(fn f) const {
+    	for (const node* p : sorted()) f(p->data);
+    }
+    template<typename fn>
+    /**
+     * calls f(a, b) for each edge in both directions, a in sorted order and b
+     * in sorted order within a. Leaves the graph as it is.
+     */
+    void traverse_edges(fn f) const {
+    	for (const node* p : sorted())
+    		for (const node* trav = p->list; trav; trav = trav->list) f(p->data, trav->data);
+    }
     template<typename fn>
     /**
      * function to traverse the edges of a graph
      */
-    void traverseEdges(fn f) {
+    void traverseEdges(fn f) const {
         if (!root) return;
         node* p = root;
         node* trav = p->list;
@@ -110,122 +403,92 @@ public:
 	}
     template<typename fn>
     /**
-     * function to traverse the vertices of a graph
-     * handles deletion of the graphs
+     * function to traverse the vertices of a graph, in sorted order.
+     * The graph is left intact, so it can be traversed again.
      */
-    void traverseVertices(fn f) {
-    	sort2();
-    	node* p = root;
-    	while (p) {
-    		f(p->data);
-    		p = p->next;
-    	}
-    	p = root;
-    	while(p){
-    		node* temp = p->next;
-    		node* listing = p->list;
-    		while(listing){
-    			node* doomed = listing->list;
-    			delete listing;
-    			listing = doomed;
-    		}
-    		listing = nullptr;
-    		delete p;
-    		p = temp;
-    	}
-    	p=nullptr;
-    	return;
+    void traverseVertices(fn f) const {
+    	traverse_vertices(f);
+    }
+    /**
+     * Colors p and the vertices after it, largest degree first (ties keep list order),
+     * with the greedy engine in O(V + E), without touching the nodes.
+     * @return the color of every vertex by id: the new ones for p onward, nodecolor for the rest
+     */
+    std::vector<int> coloring(const node *p) const {
+    	std::vector<int> order, color(byid.size());
+    	for (; p; p = p->next) order.push_back(p->id);
+    	order = largest_first(order, [&](int v){ return byid[v]->degree; });
+    	for (std::size_t i=0; i<byid.size(); i++) color[i] = byid[i]->nodecolor;
+    	greedy_coloring().run(order.data(), order.size(), [&](int v, const greedy_coloring::forbid &f){
+    		for (node* trav = byid[v]->list; trav; trav = trav->list) f(trav->id);
+    	}, color.data());
+    	return color;
     }
     /**
      * function to solve the coloring problem.
+     * Colors p and the vertices after it into their nodecolor.
      */
     void solver(node *p){
-    	if (!p) return;
-    	T* adjacent = new T[p->degree];
-    	int *used = new int[p->degree];
-    	int color=0;
-    	node* trav = p->list;
-    	// initialize the adjacency and used colors list
-    	for(int i=0; i<p->degree; i++){
-    		adjacent[i] = trav->data;
-    		used[i] = trav->nodecolor;
-    		trav = trav->list;
-    	}
-    	// Go back to the top of the list
-    	trav = root;
-    	// Go through the graph and populate the colors
-    	while(trav){
-    		for (int i=0; i<p->degree; i++)
-    			if (adjacent[i]==trav->data){
-    				used[i]=trav->nodecolor;
-    				break;
-    			}
-    		trav = trav->next;
-    	}
-    	/*
-    	 * Sort the used colors from lowest to highest
-    	 */
-    	bool swap = false;
-    	do{
-    		swap = false;
-    		for (int i=0; i<p->degree-1; i++){
-    			if(used[i]>used[i+1]){
-    				int temp = used[i];
-    				used[i] = used[i+1];
-    				used[i+1] = temp;
-    				swap = true;
-    			}
-    		}
-    	}while(swap);
-    	/*
-    	 * check the adjacent colors and increment if they are the same
-    	 */
-    	for(int i=0; i<p->degree; i++){
-    		if(used[i]==color) color++;
-    	}
-    	p->nodecolor = color;
-    	solver(p->next);
-    	delete[] adjacent;
-    	delete[] used;
+    	std::vector<int> color = coloring(p);
+    	for (; p; p = p->next) p->nodecolor = color[p->id];
     }
 private:
+    vertex_ids<T> ids;			// interned id of every vertex
+    std::vector<node*> byid;	// vertex node of every id
+    node *last = nullptr;		// end of the vertex list, where new vertices go
+
     /**
-     * private insert function to handle pointers.
+     * exchanges everything with g
      */
-    void ins(node* &p, T a, T b){
-    	if(!p){
-    		p = new node(a);
-    		p->list = new node(b);
-    		p->degree++;
+    void swap(graph &g) {
+    	std::swap(root, g.root);
+    	std::swap(current, g.current);
+    	std::swap(vert, g.vert);
+    	std::swap(totaldegree, g.totaldegree);
+    	std::swap(colored, g.colored);
+    	std::swap(ids, g.ids);
+    	std::swap(byid, g.byid);
+    	std::swap(last, g.last);
+    }
+
+    /**
+     * returns the vertex node for a, appending a new vertex if a is not in the graph yet.
+     * The interned id makes this O(1) expected instead of a walk down the vertex list.
+     */
+    node* add_vertex(const T &a){
+    	int id = ids.add(a);
+    	if (id<int(byid.size())) return byid[id];
+    	node* p = new node(a, id);
+    	(last ? last->next : root) = p;
+    	last = p;
+    	byid.push_back(p);
+    	vert++;
+    	return p;
+    }
+    /**
+     * private insert function to handle pointers: adds b to the adjacency list of a.
+     */
+    void ins(node* a, node* b){
+    	if(inslist(a->list, b->data, b->id)){
+    		a->degree++;
     		totaldegree++;
-    		vert++;
-    		return;
-    	}
-    	else if(a==p->data){
-    		if(inslist(p->list,b)){
-    			p->degree++;
-    			totaldegree++;
-    			return;
-    		}
-    		else return;
     	}
-    	else ins(p->next, a, b);
     	return;
     }
     /**
      * list insertion for adjacency list
      */
-    bool inslist(node* &p, T b){
+    bool inslist(node* &p, T b, int id){
     	if(!p){
-    		p = new node(b);
+    		p = new node(b, id);
     		return true;
     	}
     	else if (b<p->data){
-    		p = new node(b, p);
+    		p = new node(b, id, p);
     		return true;
     	}
     	else if (b==p->data) return false;
-    	else return inslist(p->list, b);
+    	else return inslist(p->list, b, id);
     }
 };
 
@@ -235,38 +498,1398 @@ template<typename T>
  */
 class solution : public graph<T> {
 public:
-	int* colors;
-	T *data;
+	std::vector<int> colors;
 	int vert;
+	static constexpr unsigned none = ~0u;	// what color() returns for a name the colored graph did not have
 	/**
 	 * solution constructor
+	 * Colors g without changing it. colors and the id table are a snapshot of g
+	 * as it was, indexed by its interned vertex ids, so the solution stays valid
+	 * when g is changed, moved or destroyed afterwards.
 	 */
-    solution(graph<T> g) {
-    	colors = new int[g.vert];
-    	data = new T[g.vert];
-    	vert = g.vert;
-    	g.current = g.root;
-    	g.solver(g.current);
-    	for(int i=0; i<vert; i++){
-    		data[i] = g.current->data;
-    		colors[i] = g.current->nodecolor;
-    		g.current = g.current->next;
-    	}
+    solution(const graph<T> &g) : colors(g.coloring(g.root)), vert(g.vert) {
+    	for(int i=0; i<vert; i++) index.add(g.vertex(i)->data);
     }
     /**
-     * destructor for solution to handle the dynamic arrays
+     * returns the color index of a node, or none if it was not in the graph when colored.
+     */
+    unsigned color(const T a) const  {
+    	int i = index.find(a);
+    	return i<0 ? none : colors[i]; }
+private:
+    vertex_ids<T> index;	// same ids as the graph's at construction, so colors[index.find(a)] is a's color
+};
+template<typename T>
+constexpr unsigned solution<T>::none;
+
+template<typename T>
+/**
+ * Graph that keeps a proper coloring in nodecolor while edges are added.
+ * A new vertex takes the smallest color none of its neighbours has. An edge
+ * between two vertices of the same color is repaired at the endpoint with
+ * fewer neighbours (the newer one on a tie), which gets the smallest color
+ * its neighbours leave free. When that would open a new color, a neighbour
+ * that alone holds some color is moved to another existing color if it can
+ * be, and the endpoint takes the color it freed. So an insert costs
+ * O(degree) of the repaired vertex plus, rarely, of those neighbours, and
+ * the count only grows when that one step of propagation fails.
+ * The graph is a member rather than a base, so every insert goes through
+ * the repair; it is readable through base().
+ */
+class colored_graph {
+public:
+	typedef typename graph<T>::node node;
+	/**
+	 * inserts the edge a-b and repairs the coloring around it
+	 * @return false, leaving the graph as it was, for a self-loop a-a, which no coloring allows
+	 */
+	bool ins(const T a, const T b) {
+		if (a==b) return false;
+		g.ins(a, b);
+		node *pa = g.find(a), *pb = g.find(b);
+		if (pa->nodecolor<0) repair(pa);
+		if (pb->nodecolor<0) repair(pb);
+		if (pa->nodecolor!=pb->nodecolor) return true;
+		bool lower = pa->degree<pb->degree || (pa->degree==pb->degree && pa->id>pb->id);
+		repair(lower ? pa : pb);
+		return true;
+	}
+	/**
+	 * the graph with its coloring in nodecolor, read-only
+	 */
+	const graph<T> &base() const {
+		return g;
+	}
+	/**
+	 * checks that every vertex has a color and no edge joins two vertices of the same color
+	 */
+	bool proper() const {
+		for (int i=0; i<g.vert; i++) {
+			const node* v = g.vertex(i);
+			if (v->nodecolor<0) return false;
+			for (const node* trav = v->list; trav; trav = trav->list)
+				if (g.vertex(trav->id)->nodecolor==v->nodecolor) return false;
+		}
+		return true;
+	}
+	/**
+	 * number of colors: one more than the largest color in use
+	 */
+	int colors() const {
+		return size.size();
+	}
+	/**
+	 * throws the coloring away and colors from scratch with solver, largest degree first
+	 */
+	void recolor() {
+		for (int i=0; i<g.vert; i++) g.vertex(i)->nodecolor = -2;
+		g.solver(g.root);
+		size.clear();
+		for (int i=0; i<g.vert; i++) {
+			int c = g.vertex(i)->nodecolor;
+			if (c>=int(size.size())) size.resize(c+1, 0);
+			size[c]++;
+		}
+	}
+private:
+	graph<T> g;
+	greedy_coloring engine;
+	std::vector<int> size;		// vertices of each color
+	std::vector<int> seen;		// scratch: neighbours of each color around the vertex being repaired
+	std::vector<node*> only;	// scratch: the last such neighbour seen
+
+	/**
+	 * the smallest color none of v's neighbours has, other than skip
+	 */
+	int smallest(node* v, int skip = -1) {
+		engine.start();
+		engine.exclude(skip);
+		for (node* trav = v->list; trav; trav = trav->list) engine.exclude(g.vertex(trav->id)->nodecolor);
+		return engine.smallest();
+	}
+	/**
+	 * gives v color c, keeping the class sizes
+	 */
+	void set(node* v, int c) {
+		if (v->nodecolor>=0) size[v->nodecolor]--;
+		v->nodecolor = c;
+		if (c>=int(size.size())) size.resize(c+1, 0);
+		size[c]++;
+		while (!size.empty() && !size.back()) size.pop_back();
+	}
+	/**
+	 * gives v a color none of its neighbours has
+	 */
+	void repair(node* v) {
+		int c = smallest(v), k = colors();
+		if (c>=k) {
+			seen.assign(k, 0);
+			only.resize(k);
+			for (node* trav = v->list; trav; trav = trav->list) {
+				node* w = g.vertex(trav->id);
+				if (w->nodecolor>=0 && w->nodecolor<k) {
+					seen[w->nodecolor]++;
+					only[w->nodecolor] = w;
+				}
+			}
+			for (int i=0; i<k; i++) {
+				if (seen[i]!=1) continue;
+				int d = smallest(only[i], i);
+				if (d>=k) continue;
+				set(only[i], d);
+				c = i;
+				break;
+			}
+		}
+		set(v, c);
+	}
+};
+
+/**
+ * Fixed pool of worker threads for running loops over vertex ranges in parallel.
+ * The calling thread takes part as worker 0, so a pool of one thread runs everything inline.
+ */
+class thread_pool {
+public:
+	/**
+	 * starts threads-1 workers (0 means one per hardware thread)
+	 */
+	explicit thread_pool(unsigned threads = 0) {
+		if (!threads) threads = std::max(1u, std::thread::hardware_concurrency());
+		for (unsigned id=1; id<threads; id++) workers.emplace_back(&thread_pool::work, this, id);
+	}
+	/**
+	 * stops and joins the workers
+	 */
+	~thread_pool() {
+		{
+			std::lock_guard<std::mutex> lock(m);
+			stop = true;
+		}
+		wake.notify_all();
+		for (std::thread &t : workers) t.join();
+	}
+	thread_pool(const thread_pool&) = delete;
+	thread_pool& operator=(const thread_pool&) = delete;
+	/**
+	 * number of threads, counting the caller
+	 */
+	unsigned size() const {
+		return workers.size()+1;
+	}
+	/**
+	 * runs f(worker) once on every thread and waits for all of them
+	 */
+	void run(const std::function<void(unsigned)> &f) {
+		{
+			std::lock_guard<std::mutex> lock(m);
+			job = &f;
+			busy = workers.size();
+			generation++;
+		}
+		wake.notify_all();
+		f(0);
+		std::unique_lock<std::mutex> lock(m);
+		done.wait(lock, [&]{ return busy==0; });
+	}
+	template<typename fn>
+	/**
+	 * calls f(begin, end, worker) over chunks of [0, n) handed out to whichever thread is free
+	 */
+	void parallel_for(std::size_t n, fn f) {
+		std::atomic<std::size_t> next(0);
+		const std::size_t chunk = std::max<std::size_t>(1024, n/(16*size()));
+		run([&](unsigned worker){
+			for (;;) {
+				std::size_t begin = next.fetch_add(chunk);
+				if (begin>=n) break;
+				f(begin, std::min(n, begin+chunk), worker);
+			}
+		});
+	}
+private:
+	std::vector<std::thread> workers;
+	std::mutex m;
+	std::condition_variable wake, done;
+	const std::function<void(unsigned)> *job = nullptr;	// what the current run asks for
+	unsigned long generation = 0;	// counts runs, so workers can tell a new one from a spurious wakeup
+	unsigned busy = 0;				// workers still on the current run
+	bool stop = false;
+
+	/**
+	 * worker loop: wait for a run, do it, report back
+	 */
+	void work(unsigned id) {
+		unsigned long seen = 0;
+		for (;;) {
+			const std::function<void(unsigned)> *f;
+			{
+				std::unique_lock<std::mutex> lock(m);
+				wake.wait(lock, [&]{ return stop || generation!=seen; });
+				if (stop) return;
+				seen = generation;
+				f = job;
+			}
+			(*f)(id);
+			std::lock_guard<std::mutex> lock(m);
+			if (--busy==0) done.notify_one();
+		}
+	}
+};
+
+template<typename It>
+/**
+ * sorts [first, last) on a thread_pool: every thread sorts one slice, then
+ * neighbouring sorted runs are merged in rounds
+ */
+void parallel_sort(It first, It last, thread_pool &pool) {
+	std::size_t n = last-first, parts = pool.size();
+	if (parts<2 || n<(1u<<16)) {
+		std::sort(first, last);
+		return;
+	}
+	std::vector<std::size_t> bound(parts+1);
+	for (std::size_t i=0; i<=parts; i++) bound[i] = n*i/parts;
+	pool.run([&](unsigned w){ std::sort(first+bound[w], first+bound[w+1]); });
+	for (std::size_t width=1; width<parts; width*=2)
+		pool.run([&](unsigned w){
+			if (w%(2*width) || w+width>=parts) return;
+			std::inplace_merge(first+bound[w], first+bound[w+width], first+bound[std::min(parts, w+2*width)]);
+		});
+}
+
+template<typename T>
+/**
+ * Compressed sparse row (CSR) form of an undirected graph.
+ * Vertices get dense ids 0..V-1 in sorted order of T, and the neighbours of
+ * vertex v are neighbors[offsets[v] .. offsets[v+1]), sorted and without
+ * duplicates. Built from an edge list by sorting in O(V + E log E), rather
+ * than the linear vertex search graph<T>::ins does for every edge.
+ * Self-loops are dropped since no coloring could satisfy them.
+ */
+class csr_graph {
+public:
+	/**
+	 * default constructor for an empty graph
+	 */
+	csr_graph() : offsets(1, 0){}
+	/**
+	 * builds the graph from a list of undirected edges; duplicates are ignored
+	 */
+	explicit csr_graph(const std::vector<std::pair<T, T>> &edges) {
+		// sort the endpoints once, numbering the distinct names as they come out
+		std::vector<std::pair<T, std::size_t>> ends;	// (name, position in edges)
+		ends.reserve(2*edges.size());
+		for (std::size_t i=0; i<edges.size(); i++) {
+			ends.emplace_back(edges[i].first, 2*i);
+			ends.emplace_back(edges[i].second, 2*i+1);
+		}
+		std::sort(ends.begin(), ends.end());
+		std::vector<std::uint32_t> ids(ends.size());
+		for (std::size_t i=0; i<ends.size(); i++) {
+			if (!i || !(ends[i].first==ends[i-1].first)) names.push_back(ends[i].first);
+			ids[ends[i].second] = names.size()-1;
+		}
+		std::vector<std::pair<T, std::size_t>>().swap(ends);
+
+		std::vector<std::uint64_t> arcs;	// (from << 32 | to), both directions
+		arcs.reserve(ids.size());
+		for (std::size_t i=0; i<ids.size(); i+=2) {
+			std::uint64_t a = ids[i], b = ids[i+1];
+			if (a==b) continue;
+			arcs.push_back(a<<32 | b);
+			arcs.push_back(b<<32 | a);
+		}
+		build(arcs);
+	}
+	/**
+	 * builds the graph from a list of undirected edges, sharing the work among the threads of pool.
+	 * Integer names over a range not much wider than the edge list are numbered
+	 * through a table over that range; others by sorting the names and binary search.
+	 * The arcs are then counted and scattered into their rows, and each row is
+	 * sorted and deduplicated on its own, instead of sorting all the arcs at once.
+	 */
+	csr_graph(const std::vector<std::pair<T, T>> &edges, thread_pool &pool) {
+		std::vector<int> ends(2*edges.size());	// ids of the ends of edge i at 2i and 2i+1
+		if (!dense_ids(edges, pool, ends, std::is_integral<T>())) sparse_ids(edges, pool, ends);
+
+		offsets.assign(names.size()+1, 0);
+		for (std::size_t i=0; i<ends.size(); i+=2)
+			if (ends[i]!=ends[i+1]) {
+				offsets[ends[i]+1]++;
+				offsets[ends[i+1]+1]++;
+			}
+		for (std::size_t v=0; v<names.size(); v++) offsets[v+1] += offsets[v];
+		neighbors.resize(offsets.back());
+		std::vector<std::size_t> fill(offsets.begin(), offsets.end()-1);
+		for (std::size_t i=0; i<ends.size(); i+=2)
+			if (ends[i]!=ends[i+1]) {
+				neighbors[fill[ends[i]]++] = ends[i+1];
+				neighbors[fill[ends[i+1]]++] = ends[i];
+			}
+		std::vector<int>().swap(ends);
+
+		std::vector<std::size_t> &kept = fill;	// distinct neighbours of each vertex
+		pool.parallel_for(names.size(), [&](std::size_t begin, std::size_t end, unsigned){
+			for (std::size_t v=begin; v<end; v++) {
+				int *row = neighbors.data()+offsets[v], *last = neighbors.data()+offsets[v+1];
+				std::sort(row, last);
+				kept[v] = std::unique(row, last)-row;
+			}
+		});
+		std::size_t at = 0;
+		for (std::size_t v=0; v<names.size(); v++) {
+			std::size_t from = offsets[v];
+			offsets[v] = at;
+			std::memmove(neighbors.data()+at, neighbors.data()+from, kept[v]*sizeof(int));
+			at += kept[v];
+		}
+		offsets.back() = at;
+		neighbors.resize(at);
+		neighbors.shrink_to_fit();
+	}
+	/**
+	 * snapshot of a graph<T>, taken from its vertex and adjacency lists
+	 */
+	explicit csr_graph(const graph<T> &g) : csr_graph(edges_of(g)){}
+	/**
+	 * number of vertices
+	 */
+	int vertices() const {
+		return names.size();
+	}
+	/**
+	 * number of undirected edges
+	 */
+	std::size_t edges() const {
+		return neighbors.size()/2;
+	}
+	/**
+	 * number of neighbours of vertex v
+	 */
+	int degree(int v) const {
+		return offsets[v+1]-offsets[v];
+	}
+	/**
+	 * first of the neighbour ids of vertex v
+	 */
+	const int *begin(int v) const {
+		return neighbors.data()+offsets[v];
+	}
+	/**
+	 * one past the last of the neighbour ids of vertex v
+	 */
+	const int *end(int v) const {
+		return neighbors.data()+offsets[v+1];
+	}
+	/**
+	 * the vertex with id v
+	 */
+	const T &name(int v) const {
+		return names[v];
+	}
+	/**
+	 * returns the id of vertex a, or -1 if it is not in the graph
+	 */
+	int id(const T &a) const {
+		auto it = std::lower_bound(names.begin(), names.end(), a);
+		return it!=names.end() && *it==a ? int(it-names.begin()) : -1;
+	}
+    template<typename fn>
+    /**
+     * function to traverse the edges of a graph, calling f(a, b) once in each direction like graph<T>
      */
-    ~solution(){
-    	delete[] colors;
-    	delete[] data;
+    void traverseEdges(fn f) const {
+    	for (int v=0; v<vertices(); v++)
+    		for (const int *u=begin(v); u!=end(v); u++)
+    			f(names[v], names[*u]);
     }
+    template<typename fn>
     /**
-     * returns the color index of a node.
+     * function to traverse the vertices of a graph in sorted order
      */
-    unsigned color(const T a) const  {
-    	int index = 0;
-    	for(int i=0; i<vert; i++){
-    		if(data[i] == a) index = i;
-    	}
-    	return colors[index]; }
+    void traverseVertices(fn f) const {
+    	for (const T &a : names) f(a);
+    }
+private:
+	std::vector<T> names;				// vertex names, sorted; the index is the id
+	std::vector<std::size_t> offsets;	// vertices()+1 offsets into neighbors
+	std::vector<int> neighbors;			// neighbour ids of every vertex, back to back
+
+	/**
+	 * names and end ids for integer names spanning at most a few times as many
+	 * values as there are edge ends: marks the names present in a table over
+	 * the range and numbers them in order, so each end is named by one lookup.
+	 * @return false, doing nothing, if the range is too wide
+	 */
+	bool dense_ids(const std::vector<std::pair<T, T>> &edges, thread_pool &pool, std::vector<int> &ends, std::true_type) {
+		if (edges.empty()) return false;
+		std::vector<T> low(pool.size(), edges[0].first), high(low);
+		pool.parallel_for(edges.size(), [&](std::size_t begin, std::size_t end, unsigned w){
+			for (std::size_t i=begin; i<end; i++) {
+				low[w] = std::min(low[w], std::min(edges[i].first, edges[i].second));
+				high[w] = std::max(high[w], std::max(edges[i].first, edges[i].second));
+			}
+		});
+		T least = *std::min_element(low.begin(), low.end()), most = *std::max_element(high.begin(), high.end());
+		std::uint64_t range = std::uint64_t(most)-std::uint64_t(least);
+		if (range>=4*edges.size()+1024) return false;
+		std::vector<int> rank(range+1, -1);
+		for (const std::pair<T, T> &e : edges) {
+			rank[std::uint64_t(e.first)-std::uint64_t(least)] = 0;
+			rank[std::uint64_t(e.second)-std::uint64_t(least)] = 0;
+		}
+		for (std::uint64_t x=0; x<=range; x++)
+			if (!rank[x]) {
+				rank[x] = names.size();
+				names.push_back(T(std::uint64_t(least)+x));
+			}
+		pool.parallel_for(edges.size(), [&](std::size_t begin, std::size_t end, unsigned){
+			for (std::size_t i=begin; i<end; i++) {
+				ends[2*i] = rank[std::uint64_t(edges[i].first)-std::uint64_t(least)];
+				ends[2*i+1] = rank[std::uint64_t(edges[i].second)-std::uint64_t(least)];
+			}
+		});
+		return true;
+	}
+	bool dense_ids(const std::vector<std::pair<T, T>> &, thread_pool &, std::vector<int> &, std::false_type) {
+		return false;
+	}
+	/**
+	 * names and end ids for any names: sorts the distinct names, then finds each end by binary search
+	 */
+	void sparse_ids(const std::vector<std::pair<T, T>> &edges, thread_pool &pool, std::vector<int> &ends) {
+		names.resize(2*edges.size());
+		pool.parallel_for(edges.size(), [&](std::size_t begin, std::size_t end, unsigned){
+			for (std::size_t i=begin; i<end; i++) {
+				names[2*i] = edges[i].first;
+				names[2*i+1] = edges[i].second;
+			}
+		});
+		parallel_sort(names.begin(), names.end(), pool);
+		names.erase(std::unique(names.begin(), names.end()), names.end());
+		names.shrink_to_fit();
+		pool.parallel_for(edges.size(), [&](std::size_t begin, std::size_t end, unsigned){
+			for (std::size_t i=begin; i<end; i++) {
+				ends[2*i] = id(edges[i].first);
+				ends[2*i+1] = id(edges[i].second);
+			}
+		});
+	}
+
+	/**
+	 * every adjacency of g as an edge list
+	 */
+	static std::vector<std::pair<T, T>> edges_of(const graph<T> &g) {
+		std::vector<std::pair<T, T>> edges;
+		edges.reserve(g.totaldegree);
+		for (const typename graph<T>::node* p = g.root; p; p = p->next)
+			for (const typename graph<T>::node* trav = p->list; trav; trav = trav->list)
+				edges.emplace_back(p->data, trav->data);
+		return edges;
+	}
+
+	/**
+	 * fills offsets and neighbors from arcs packed as (from << 32 | to); sorts and dedupes arcs in place
+	 */
+	void build(std::vector<std::uint64_t> &arcs) {
+		std::sort(arcs.begin(), arcs.end());
+		arcs.erase(std::unique(arcs.begin(), arcs.end()), arcs.end());
+		offsets.assign(names.size()+1, 0);
+		neighbors.resize(arcs.size());
+		for (std::size_t i=0; i<arcs.size(); i++) {
+			offsets[(arcs[i]>>32)+1]++;
+			neighbors[i] = int(arcs[i] & 0xFFFFFFFFu);
+		}
+		for (std::size_t v=0; v<names.size(); v++) offsets[v+1] += offsets[v];
+	}
+};
+
+template<typename T>
+/**
+ * greedy coloring of a csr_graph in the given vertex order
+ * @return the color of every vertex id
+ */
+std::vector<int> greedy_color(const csr_graph<T> &g, const std::vector<int> &order) {
+	std::vector<int> color(g.vertices(), -1);
+	greedy_coloring().run(order.data(), order.size(), [&](int v, const greedy_coloring::forbid &f){
+		for (const int *u=g.begin(v); u!=g.end(v); u++) f(*u);
+	}, color.data());
+	return color;
+}
+
+/**
+ * vertex orderings for coloring a csr_graph
+ */
+enum class coloring_order {
+	largest_first,	// by degree, largest first
+	smallest_last,	// reverse of repeatedly removing a vertex of least remaining degree
+	dsatur			// next is the uncolored vertex seeing the most distinct colors
 };
+
+template<typename T>
+/**
+ * every vertex id of g ordered by degree, largest first, by counting sort
+ */
+std::vector<int> largest_first_order(const csr_graph<T> &g) {
+	std::vector<int> ids(g.vertices());
+	for (int v=0; v<g.vertices(); v++) ids[v] = v;
+	return largest_first(ids, [&](int v){ return g.degree(v); });
+}
+
+template<typename T>
+/**
+ * smallest-last (degeneracy) order of g in O(V + E).
+ * Repeatedly removes a vertex of least degree among those left, using a
+ * bucket queue on remaining degree; the order is the reverse of removal.
+ */
+std::vector<int> smallest_last_order(const csr_graph<T> &g) {
+	int n = g.vertices(), most = 0;
+	for (int v=0; v<n; v++) most = std::max(most, g.degree(v));
+	bucket_queue q(n, most+1);
+	for (int v=0; v<n; v++) q.push(v, g.degree(v));
+	std::vector<int> order(n);
+	int low = 0;
+	for (int i=n-1; i>=0; i--) {
+		while (q.front(low)<0) low++;
+		int v = q.front(low);
+		q.erase(v);
+		order[i] = v;
+		for (const int *u=g.begin(v); u!=g.end(v); u++)
+			if (q.key(*u)>0) q.move(*u, q.key(*u)-1);
+		if (low>0) low--;	// a neighbour may have dropped one below
+	}
+	return order;
+}
+
+template<typename T>
+/**
+ * DSatur coloring of g in O(V + E) expected.
+ * The next vertex is the uncolored one with the most distinct colors among
+ * its neighbours (its saturation), kept in a bucket queue on saturation.
+ * Whether a vertex already sees a color is kept in a hash set of
+ * (vertex, color) pairs. Ties go to the vertex that reached the bucket last,
+ * and at the start to the largest degree.
+ * @return the color of every vertex id
+ */
+std::vector<int> dsatur_color(const csr_graph<T> &g) {
+	int n = g.vertices(), most = 0;
+	for (int v=0; v<n; v++) most = std::max(most, g.degree(v));
+	bucket_queue q(n, most+2);
+	std::vector<int> first = largest_first_order(g);
+	for (int i=n-1; i>=0; i--) q.push(first[i], 0);
+
+	std::size_t size = 16;
+	while (size<4*g.edges()+16) size *= 2;
+	std::vector<std::uint64_t> seen(size, ~0ULL);	// (vertex << 32 | color), ~0 when empty
+	auto see = [&](std::uint64_t u, std::uint64_t c) {	// true if u had not seen c before
+		std::uint64_t key = u<<32 | c;
+		std::size_t i = (key*0x9E3779B97F4A7C15ULL)>>32 & (size-1);
+		while (seen[i]!=~0ULL) {
+			if (seen[i]==key) return false;
+			i = (i+1)&(size-1);
+		}
+		seen[i] = key;
+		return true;
+	};
+
+	std::vector<int> color(n, -1);
+	greedy_coloring engine;
+	auto neighbors = [&](int v, const greedy_coloring::forbid &f){
+		for (const int *u=g.begin(v); u!=g.end(v); u++) f(*u);
+	};
+	int top = 0;
+	for (int i=0; i<n; i++) {
+		while (q.front(top)<0) top--;
+		int v = q.front(top);
+		q.erase(v);
+		engine.run(&v, 1, neighbors, color.data());
+		for (const int *u=g.begin(v); u!=g.end(v); u++) {
+			if (color[*u]>=0 || !see(*u, color[v])) continue;
+			q.move(*u, q.key(*u)+1);
+			top = std::max(top, q.key(*u));
+		}
+	}
+	return color;
+}
+
+template<typename T>
+/**
+ * colors g greedily in the chosen order
+ * @return the color of every vertex id
+ */
+std::vector<int> color_graph(const csr_graph<T> &g, coloring_order how) {
+	switch (how) {
+	case coloring_order::smallest_last: return greedy_color(g, smallest_last_order(g));
+	case coloring_order::dsatur: return dsatur_color(g);
+	default: return greedy_color(g, largest_first_order(g));
+	}
+}
+
+/**
+ * reads the edges of a graph in DIMACS format: "c" comment lines, one
+ * "p edge V E" line, then "e u v" lines with vertices numbered from 1.
+ * Vertices without edges are not represented.
+ */
+inline std::vector<std::pair<int, int>> read_dimacs(std::istream &in) {
+	std::vector<std::pair<int, int>> edges;
+	std::string kind;
+	while (in>>kind) {
+		if (kind=="e") {
+			int a, b;
+			if (!(in>>a>>b)) break;
+			edges.emplace_back(a, b);
+		}
+		else if (kind=="p") {
+			std::string format;
+			long v, e;
+			if (in>>format>>v>>e) edges.reserve(e);
+		}
+		if (!in.ignore(1<<30, '\n')) break;
+	}
+	return edges;
+}
+
+/**
+ * The bytes of a file, memory-mapped, or read in large blocks when it cannot be mapped.
+ */
+class file_bytes {
+public:
+	/**
+	 * maps or reads the file at path; good() is false if it could not be opened
+	 */
+	explicit file_bytes(const char *path) {
+		int fd = open(path, O_RDONLY);
+		if (fd<0) return;
+		ok = true;
+		struct stat st;
+		if (fstat(fd, &st)==0 && S_ISREG(st.st_mode) && st.st_size>0) {
+			void *p = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+			if (p!=MAP_FAILED) {
+				madvise(p, st.st_size, MADV_SEQUENTIAL);
+				first = static_cast<const char*>(p);
+				count = st.st_size;
+				mapped = true;
+			}
+		}
+		if (!mapped) {
+			const std::size_t block = 1<<20;
+			for (ssize_t got = 1; got>0; ) {
+				copy.resize(count+block);
+				got = read(fd, &copy[count], block);
+				if (got>0) count += got;
+			}
+			first = copy.data();
+		}
+		close(fd);
+	}
+	~file_bytes() {
+		if (mapped) munmap(const_cast<char*>(first), count);
+	}
+	file_bytes(const file_bytes&) = delete;
+	file_bytes& operator=(const file_bytes&) = delete;
+	bool good() const {
+		return ok;
+	}
+	const char *begin() const {
+		return first;
+	}
+	const char *end() const {
+		return first+count;
+	}
+private:
+	const char *first = nullptr;
+	std::size_t count = 0;
+	bool ok = false, mapped = false;
+	std::vector<char> copy;	// the bytes, when they are read rather than mapped
+};
+
+template<typename T>
+/**
+ * parses an integer at p, after any blanks or commas; advances p past it.
+ * @return false, leaving p where the number should have started, if there is none
+ */
+bool parse_integer(const char *&p, const char *end, T &x) {
+	while (p<end && (*p==' ' || *p=='\t' || *p==',')) p++;
+	bool negative = p<end && *p=='-';
+	const char *q = p+negative;
+	if (q>=end || unsigned(*q-'0')>9) return false;
+	T value = 0;
+	for (; q<end && unsigned(*q-'0')<=9; q++) value = value*10+(*q-'0');
+	x = negative ? T(0)-value : value;
+	p = q;
+	return true;
+}
+
+template<typename T>
+/**
+ * appends the edges in the text [p, end) to edges. A line holding two
+ * integers "a b" (or "e a b" as in DIMACS), separated by blanks or commas,
+ * is an edge; anything after them, like a weight, is ignored. Other lines,
+ * such as comments and headers, are skipped.
+ */
+void parse_edges(const char *p, const char *end, std::vector<std::pair<T, T>> &edges) {
+	while (p<end) {
+		while (p<end && (*p==' ' || *p=='\t')) p++;
+		if (p<end && *p=='e') p++;
+		T a, b;
+		if (parse_integer(p, end, a) && parse_integer(p, end, b)) edges.emplace_back(a, b);
+		p = static_cast<const char*>(std::memchr(p, '\n', end-p));
+		p = p ? p+1 : end;
+	}
+}
+
+template<typename T = int>
+/**
+ * Loads a text edge list into a csr_graph in one pass. The file is mapped
+ * (or read in large blocks), split at line breaks into pieces that the
+ * threads of pool parse on their own, and the edges are deduplicated and
+ * symmetrized by the parallel sorts of the csr_graph constructor, with no
+ * per-edge insertion. See parse_edges for the accepted format.
+ * @return an empty graph if the file cannot be opened
+ */
+csr_graph<T> load_edge_list(const char *path, thread_pool &pool) {
+	file_bytes file(path);
+	if (!file.good()) return csr_graph<T>();
+	const char *text = file.begin();
+	std::size_t length = file.end()-text;
+	std::size_t pieces = std::max<std::size_t>(1, std::min<std::size_t>(8*pool.size(), length>>16));
+	std::vector<const char*> cut(pieces+1, file.end());	// piece i is [cut[i], cut[i+1])
+	cut[0] = text;
+	for (std::size_t i=1; i<pieces; i++) {
+		const char *p = std::max(cut[i-1], text+length*i/pieces);
+		const void *line = std::memchr(p, '\n', file.end()-p);
+		cut[i] = line ? static_cast<const char*>(line)+1 : file.end();
+	}
+
+	std::vector<std::vector<std::pair<T, T>>> parsed(pieces);
+	std::atomic<std::size_t> next(0);
+	pool.run([&](unsigned){
+		for (std::size_t i; (i = next.fetch_add(1))<pieces;) parse_edges(cut[i], cut[i+1], parsed[i]);
+	});
+	std::vector<std::size_t> at(pieces+1, 0);
+	for (std::size_t i=0; i<pieces; i++) at[i+1] = at[i]+parsed[i].size();
+	std::vector<std::pair<T, T>> edges(at[pieces]);
+	next = 0;
+	pool.run([&](unsigned){
+		for (std::size_t i; (i = next.fetch_add(1))<pieces;) {
+			std::copy(parsed[i].begin(), parsed[i].end(), edges.begin()+at[i]);
+			std::vector<std::pair<T, T>>().swap(parsed[i]);
+		}
+	});
+	return csr_graph<T>(edges, pool);
+}
+
+/**
+ * random priority of vertex v for a given seed (splitmix64), ties broken by id
+ */
+inline std::uint64_t vertex_priority(std::uint32_t v, std::uint64_t seed) {
+	std::uint64_t z = (std::uint64_t(v)<<32 | v) + seed*0x9E3779B97F4A7C15ULL;
+	z = (z^(z>>30))*0xBF58476D1CE4E5B9ULL;
+	z = (z^(z>>27))*0x94D049BB133111EBULL;
+	return (z^(z>>31))<<32 | v;
+}
+
+template<typename T>
+/**
+ * Jones-Plassmann parallel coloring.
+ * Every vertex gets a random priority. Each round, the uncolored vertices
+ * whose priority beats all their uncolored neighbours form an independent
+ * set, and each of them takes the smallest color free around it. Finding
+ * that set and coloring it are two separate parallel passes, so no thread
+ * reads a color another thread is writing.
+ * @return the color of every vertex id
+ */
+std::vector<int> jones_plassmann_color(const csr_graph<T> &g, thread_pool &pool, std::uint64_t seed = 1) {
+	int n = g.vertices();
+	std::vector<int> color(n, -1), work(n);
+	std::vector<char> ready(n);
+	std::vector<greedy_coloring> engines(pool.size());
+	for (int v=0; v<n; v++) work[v] = v;
+	while (!work.empty()) {
+		pool.parallel_for(work.size(), [&](std::size_t begin, std::size_t end, unsigned){
+			for (std::size_t i=begin; i<end; i++) {
+				int v = work[i];
+				std::uint64_t mine = vertex_priority(v, seed);
+				bool top = true;
+				for (const int *u=g.begin(v); top && u!=g.end(v); u++)
+					top = color[*u]>=0 || vertex_priority(*u, seed)<mine;
+				ready[i] = top;
+			}
+		});
+		pool.parallel_for(work.size(), [&](std::size_t begin, std::size_t end, unsigned worker){
+			for (std::size_t i=begin; i<end; i++)
+				if (ready[i]) engines[worker].run(&work[i], 1, [&](int v, const greedy_coloring::forbid &f){
+					for (const int *u=g.begin(v); u!=g.end(v); u++) f(*u);
+				}, color.data());
+		});
+		std::size_t left = 0;
+		for (std::size_t i=0; i<work.size(); i++)
+			if (!ready[i]) work[left++] = work[i];
+		work.resize(left);
+	}
+	return color;
+}
+
+template<typename T>
+/**
+ * Speculative parallel coloring (color, then fix conflicts).
+ * All vertices still to do are colored greedily in parallel, reading their
+ * neighbours' colors as they stand, which may be stale. Then every edge is
+ * checked in parallel, and where both ends took the same color the end with
+ * the larger id goes back on the list. Repeats until there are no conflicts.
+ * @return the color of every vertex id
+ */
+std::vector<int> speculative_color(const csr_graph<T> &g, thread_pool &pool) {
+	int n = g.vertices();
+	std::vector<std::atomic<int>> color(n);
+	for (auto &c : color) c.store(-1, std::memory_order_relaxed);
+	std::vector<int> work(n);
+	for (int v=0; v<n; v++) work[v] = v;
+	std::vector<greedy_coloring> engines(pool.size());
+	std::vector<std::vector<int>> redo(pool.size());
+	while (!work.empty()) {
+		pool.parallel_for(work.size(), [&](std::size_t begin, std::size_t end, unsigned worker){
+			greedy_coloring &engine = engines[worker];
+			for (std::size_t i=begin; i<end; i++) {
+				int v = work[i];
+				engine.start();
+				for (const int *u=g.begin(v); u!=g.end(v); u++) engine.exclude(color[*u].load(std::memory_order_relaxed));
+				color[v].store(engine.smallest(), std::memory_order_relaxed);
+			}
+		});
+		pool.parallel_for(work.size(), [&](std::size_t begin, std::size_t end, unsigned worker){
+			for (std::size_t i=begin; i<end; i++) {
+				int v = work[i], c = color[v].load(std::memory_order_relaxed);
+				for (const int *u=g.begin(v); u!=g.end(v); u++)
+					if (*u<v && color[*u].load(std::memory_order_relaxed)==c) {
+						redo[worker].push_back(v);
+						break;
+					}
+			}
+		});
+		work.clear();
+		for (auto &r : redo) {
+			work.insert(work.end(), r.begin(), r.end());
+			r.clear();
+		}
+	}
+	std::vector<int> result(n);
+	for (int v=0; v<n; v++) result[v] = color[v].load(std::memory_order_relaxed);
+	return result;
+}
+
+/**
+ * result of exact_color
+ */
+struct exact_result {
+	std::vector<int> color;	// best coloring found, by vertex id
+	int colors;				// number of colors it uses
+	int lower_bound;		// size of the clique found, so no coloring uses fewer colors
+	bool optimal;			// true if colors is proved to be the chromatic number
+	long nodes;				// search tree nodes visited
+};
+
+/**
+ * Exact minimum coloring by DSatur branch and bound over bitsets.
+ * Vertex sets (adjacency rows, color classes, the uncolored set) are bitsets,
+ * so "does v touch class c" and "how many uncolored neighbours" are a few
+ * word ANDs and popcounts. A greedy clique gives the lower bound and is
+ * colored up front to break symmetry. The search stops when it meets the
+ * lower bound, proves no better coloring exists, or runs out of time.
+ * Practical up to a couple of hundred vertices, depending on density.
+ */
+class exact_coloring {
+public:
+	template<typename T>
+	/**
+	 * builds the bitset adjacency of g
+	 */
+	explicit exact_coloring(const csr_graph<T> &g) : n(g.vertices()), words((n+63)/64), adj(std::size_t(n)*words, 0) {
+		for (int v=0; v<n; v++)
+			for (const int *u=g.begin(v); u!=g.end(v); u++) set(row(v), *u);
+	}
+	/**
+	 * searches for a coloring with fewer colors than initial, which must be a valid coloring
+	 * @param budget seconds to search before settling for the best found so far
+	 * @param threads threads to share the subtrees of the search among
+	 */
+	exact_result solve(const std::vector<int> &initial, double budget = 10, unsigned threads = 1) {
+		shared sh;
+		sh.deadline = std::chrono::steady_clock::now()+std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(budget));
+		sh.best_color = initial;
+		int used = 0;
+		for (int c : initial) used = std::max(used, c+1);
+		sh.best = used;
+
+		state root = start(sh);
+		if (root.left==0 || sh.best<=sh.lower) sh.stop = true;
+		if (!sh.stop) {
+			if (threads<=1) {
+				long local = 0;
+				dfs(root, sh, local);
+				sh.nodes += local;
+			}
+			else {
+				std::vector<state> frontier = split(root, sh, 8*threads);
+				std::atomic<std::size_t> next(0);
+				thread_pool pool(threads);
+				pool.run([&](unsigned){
+					long local = 0;
+					for (std::size_t i; !sh.stop && (i = next.fetch_add(1))<frontier.size();) dfs(frontier[i], sh, local);
+					sh.nodes += local;
+				});
+			}
+		}
+		exact_result r;
+		r.color = sh.best_color;
+		r.colors = sh.best;
+		r.lower_bound = sh.lower;
+		r.optimal = !sh.timeout || sh.best<=sh.lower;
+		r.nodes = sh.nodes;
+		return r;
+	}
+private:
+	/**
+	 * partial coloring: the color of every vertex (-1 if none), the uncolored set, and one bitset per color class
+	 */
+	struct state {
+		std::vector<int> color;
+		std::vector<std::uint64_t> uncolored, classes;
+		int k = 0;		// color classes in use
+		int left = 0;	// uncolored vertices
+	};
+	/**
+	 * what the threads of one search share
+	 */
+	struct shared {
+		std::mutex m;
+		std::vector<int> best_color;	// guarded by m
+		std::atomic<int> best{0};		// colors in best_color
+		std::atomic<bool> stop{false}, timeout{false};
+		std::atomic<long> nodes{0};
+		int lower = 0;
+		std::chrono::steady_clock::time_point deadline;
+	};
+	int n, words;
+	std::vector<std::uint64_t> adj;	// n rows of words
+
+	std::uint64_t *row(int v) { return &adj[std::size_t(v)*words]; }
+	const std::uint64_t *row(int v) const { return &adj[std::size_t(v)*words]; }
+	static void set(std::uint64_t *b, int v) { b[v>>6] |= 1ULL<<(v&63); }
+	static void clear(std::uint64_t *b, int v) { b[v>>6] &= ~(1ULL<<(v&63)); }
+	bool meets(const std::uint64_t *a, const std::uint64_t *b) const {
+		for (int w=0; w<words; w++) if (a[w]&b[w]) return true;
+		return false;
+	}
+	int common(const std::uint64_t *a, const std::uint64_t *b) const {
+		int count = 0;
+		for (int w=0; w<words; w++) count += __builtin_popcountll(a[w]&b[w]);
+		return count;
+	}
+
+	/**
+	 * greedy clique: from each vertex, keep adding the candidate with the most
+	 * neighbours among the remaining candidates; returns the largest one found
+	 */
+	std::vector<int> clique() const {
+		std::vector<int> best, current;
+		std::vector<std::uint64_t> cand(words);
+		for (int v=0; v<n; v++) {
+			current.assign(1, v);
+			std::copy(row(v), row(v)+words, cand.begin());
+			for (;;) {
+				int pick = -1, most = -1;
+				for (int w=0; w<words; w++)
+					for (std::uint64_t b=cand[w]; b; b &= b-1) {
+						int u = 64*w+__builtin_ctzll(b);
+						int d = common(row(u), cand.data());
+						if (d>most) most = d, pick = u;
+					}
+				if (pick<0) break;
+				current.push_back(pick);
+				for (int w=0; w<words; w++) cand[w] &= row(pick)[w];
+			}
+			if (current.size()>best.size()) best = current;
+		}
+		return best;
+	}
+
+	/**
+	 * the root of the search: a clique colored 0, 1, 2, ... and everything else uncolored
+	 */
+	state start(shared &sh) const {
+		state s;
+		s.color.assign(n, -1);
+		s.uncolored.assign(words, 0);
+		for (int v=0; v<n; v++) set(s.uncolored.data(), v);
+		s.left = n;
+		std::vector<int> k = clique();
+		sh.lower = k.size();
+		for (int v : k) {
+			s.classes.resize((s.k+1)*words, 0);
+			assign(s, v, s.k++);
+		}
+		return s;
+	}
+	void assign(state &s, int v, int c) const {
+		s.color[v] = c;
+		set(&s.classes[std::size_t(c)*words], v);
+		clear(s.uncolored.data(), v);
+		s.left--;
+	}
+	void unassign(state &s, int v, int c) const {
+		s.color[v] = -1;
+		clear(&s.classes[std::size_t(c)*words], v);
+		set(s.uncolored.data(), v);
+		s.left++;
+	}
+
+	/**
+	 * DSatur choice: the uncolored vertex next to the most color classes,
+	 * ties going to the most uncolored neighbours
+	 */
+	int pick(const state &s) const {
+		int best = -1, best_sat = -1, best_deg = -1;
+		for (int w=0; w<words; w++)
+			for (std::uint64_t b=s.uncolored[w]; b; b &= b-1) {
+				int v = 64*w+__builtin_ctzll(b), sat = 0;
+				for (int c=0; c<s.k; c++) sat += meets(row(v), &s.classes[std::size_t(c)*words]);
+				if (sat<best_sat) continue;
+				int deg = common(row(v), s.uncolored.data());
+				if (sat>best_sat || deg>best_deg) best = v, best_sat = sat, best_deg = deg;
+			}
+		return best;
+	}
+
+	/**
+	 * a complete coloring with s.k colors: keep it if it is the best so far
+	 */
+	void record(const state &s, shared &sh) const {
+		std::lock_guard<std::mutex> lock(sh.m);
+		if (s.k>=sh.best) return;
+		sh.best = s.k;
+		sh.best_color = s.color;
+		if (sh.best<=sh.lower) sh.stop = true;
+	}
+
+	/**
+	 * depth-first branch and bound below s; s is back as it was on return
+	 */
+	void dfs(state &s, shared &sh, long &nodes) const {
+		if (sh.stop) return;
+		if ((++nodes&4095)==0 && std::chrono::steady_clock::now()>sh.deadline) {
+			sh.timeout = true;
+			sh.stop = true;
+			return;
+		}
+		if (!s.left) {
+			record(s, sh);
+			return;
+		}
+		if (s.k>=sh.best) return;
+		int v = pick(s);
+		for (int c=0; c<s.k && s.k<sh.best && !sh.stop; c++) {
+			if (meets(row(v), &s.classes[std::size_t(c)*words])) continue;
+			assign(s, v, c);
+			dfs(s, sh, nodes);
+			unassign(s, v, c);
+		}
+		if (s.k+1<sh.best && !sh.stop) {
+			s.classes.resize((s.k+1)*words, 0);
+			assign(s, v, s.k++);
+			dfs(s, sh, nodes);
+			unassign(s, v, --s.k);
+			s.classes.resize(s.k*words);
+		}
+	}
+
+	/**
+	 * expands the search breadth first until there are at least count subtrees to hand out
+	 */
+	std::vector<state> split(const state &root, shared &sh, std::size_t count) const {
+		std::vector<state> level(1, root);
+		while (!level.empty() && level.size()<count) {
+			std::vector<state> next;
+			for (state &s : level) {
+				if (!s.left) {
+					record(s, sh);
+					continue;
+				}
+				if (s.k>=sh.best) continue;
+				int v = pick(s);
+				for (int c=0; c<=s.k; c++) {
+					if (c==s.k ? s.k+1>=sh.best : meets(row(v), &s.classes[std::size_t(c)*words])) continue;
+					state child = s;
+					if (c==s.k) child.classes.resize((++child.k)*words, 0);
+					assign(child, v, c);
+					next.push_back(std::move(child));
+				}
+			}
+			if (next.empty()) return next;
+			level.swap(next);
+		}
+		return level;
+	}
+};
+
+template<typename T>
+/**
+ * exact minimum coloring of g, starting from the DSatur coloring as the bound to beat
+ * @param budget seconds before settling for the best coloring found so far
+ * @param threads threads to share the search among
+ */
+exact_result exact_color(const csr_graph<T> &g, double budget = 10, unsigned threads = 1) {
+	return exact_coloring(g).solve(dsatur_color(g), budget, threads);
+}
+
+/**
+ * Buffered text output for the exporters: integers and strings are formatted
+ * into a 64 KB buffer that is handed to the stream in blocks, so a large
+ * export streams out at a steady pace rather than growing one big string.
+ * Anything else goes through the stream's own operator<<.
+ */
+class text_sink {
+public:
+	explicit text_sink(std::ostream &out) : out(out), used(0){}
+	~text_sink() {
+		flush();
+	}
+	text_sink(const text_sink&) = delete;
+	text_sink& operator=(const text_sink&) = delete;
+	text_sink &operator<<(char c) {
+		if (used==sizeof buffer) flush();
+		buffer[used++] = c;
+		return *this;
+	}
+	text_sink &operator<<(const char *s) {
+		return write(s, std::strlen(s));
+	}
+	text_sink &operator<<(const std::string &s) {
+		return write(s.data(), s.size());
+	}
+	template<typename T>
+	text_sink &operator<<(const T &x) {
+		put(x, std::is_integral<T>());
+		return *this;
+	}
+	text_sink &write(const char *s, std::size_t n) {
+		if (used+n>sizeof buffer) {
+			flush();
+			if (n>sizeof buffer) {
+				out.write(s, n);
+				return *this;
+			}
+		}
+		std::memcpy(buffer+used, s, n);
+		used += n;
+		return *this;
+	}
+	void flush() {
+		out.write(buffer, used);
+		used = 0;
+	}
+private:
+	std::ostream &out;
+	char buffer[1<<16];
+	std::size_t used;
+
+	template<typename T>
+	void put(T x, std::true_type) {
+		char digits[24], *p = digits+sizeof digits;
+		bool negative = x<0;
+		unsigned long long u = negative ? 0ULL-(unsigned long long)x : (unsigned long long)x;
+		do *--p = '0'+u%10; while (u /= 10);
+		if (negative) *--p = '-';
+		write(p, digits+sizeof digits-p);
+	}
+	template<typename T>
+	void put(const T &x, std::false_type) {
+		flush();
+		out << x;
+	}
+};
+
+template<typename T>
+/**
+ * writes a vertex name as a dot ID, in double quotes
+ */
+void dot_name(text_sink &out, const T &a) {
+	out << '"' << a << '"';
+}
+/**
+ * writes a string vertex name as a dot ID, escaping quotes and backslashes
+ */
+inline void dot_name(text_sink &out, const std::string &a) {
+	out << '"';
+	for (char c : a) {
+		if (c=='"' || c=='\\') out << '\\';
+		out << c;
+	}
+	out << '"';
+}
+template<typename T>
+/**
+ * writes a vertex name as a CSV field
+ */
+void csv_name(text_sink &out, const T &a) {
+	out << a;
+}
+/**
+ * writes a string vertex name as a CSV field, quoted if it holds a comma, quote or line break
+ */
+inline void csv_name(text_sink &out, const std::string &a) {
+	if (a.find_first_of(",\"\r\n")==std::string::npos) {
+		out << a;
+		return;
+	}
+	out << '"';
+	for (char c : a) {
+		if (c=='"') out << '"';
+		out << c;
+	}
+	out << '"';
+}
+
+/**
+ * dot colors for color classes 0..15, reused in turn for larger classes; uncolored vertices are white
+ */
+static const char *const dot_colors[] = {"black","red","blue","darkgreen","brown","orange","pink","purple","lightgrey","darkgray","tan","coral","yellow","cyan","green","magenta"};
+
+template<typename T>
+/**
+ * streams g and its coloring to out as an undirected graph in dot format,
+ * every edge once, then every vertex with its fill color
+ * @param color color of every vertex id, negative if uncolored
+ */
+void write_dot(std::ostream &stream, const csr_graph<T> &g, const std::vector<int> &color) {
+	text_sink out(stream);
+	out << "graph {\n\tnode [style=filled];\n";
+	for (int v=0; v<g.vertices(); v++)
+		for (const int *u=g.begin(v); u!=g.end(v); u++) {
+			if (*u<v) continue;
+			out << '\t';
+			dot_name(out, g.name(v));
+			out << " -- ";
+			dot_name(out, g.name(*u));
+			out << ";\n";
+		}
+	for (int v=0; v<g.vertices(); v++) {
+		out << '\t';
+		dot_name(out, g.name(v));
+		out << " [fillcolor=" << (color[v]<0 ? "white" : dot_colors[color[v]&0xF]) << "];\n";
+	}
+	out << "}\n";
+}
+
+template<typename T>
+/**
+ * streams the coloring to out as CSV: a "vertex,color" header, then one line per vertex in id order
+ */
+void write_csv(std::ostream &stream, const csr_graph<T> &g, const std::vector<int> &color) {
+	text_sink out(stream);
+	out << "vertex,color\n";
+	for (int v=0; v<g.vertices(); v++) {
+		csv_name(out, g.name(v));
+		out << ',' << color[v] << '\n';
+	}
+}
+
+/**
+ * Streams a coloring in a compact binary form: the bytes "GCOL", then as
+ * little-endian 32-bit words the vertex count and the bytes per color
+ * (1, 2 or 4, the fewest that hold the largest color plus one), then the
+ * color plus one of every vertex id in that many little-endian bytes, so
+ * that 0 is uncolored. Vertex ids are those of the csr_graph colored.
+ */
+inline void write_coloring(std::ostream &stream, const std::vector<int> &color) {
+	int most = 0;
+	for (int c : color) most = std::max(most, c+1);
+	std::uint32_t width = most<0x100 ? 1 : most<0x10000 ? 2 : 4;
+	text_sink out(stream);
+	auto word = [&](std::uint32_t x, std::uint32_t bytes){
+		char b[4];
+		for (std::uint32_t i=0; i<bytes; i++) b[i] = char(x>>8*i & 0xFF);
+		out.write(b, bytes);
+	};
+	out.write("GCOL", 4);
+	word(color.size(), 4);
+	word(width, 4);
+	for (int c : color) word(std::uint32_t(std::max(c, -1)+1), width);
+}
+
+/**
+ * reads a coloring written by write_coloring
+ * @return the color of every vertex id, -1 if uncolored; empty if the input is not in that form
+ */
+inline std::vector<int> read_coloring(std::istream &in) {
+	char magic[4];
+	unsigned char head[8];
+	if (!in.read(magic, 4) || std::memcmp(magic, "GCOL", 4) || !in.read(reinterpret_cast<char*>(head), 8)) return std::vector<int>();
+	auto word = [](const unsigned char *p, std::uint32_t bytes){
+		std::uint32_t x = 0;
+		for (std::uint32_t i=0; i<bytes; i++) x |= std::uint32_t(p[i])<<8*i;
+		return x;
+	};
+	std::uint32_t count = word(head, 4), width = word(head+4, 4);
+	if (width!=1 && width!=2 && width!=4) return std::vector<int>();
+	std::vector<unsigned char> bytes(std::size_t(count)*width);
+	if (!in.read(reinterpret_cast<char*>(bytes.data()), bytes.size())) return std::vector<int>();
+	std::vector<int> color(count);
+	for (std::uint32_t v=0; v<count; v++) color[v] = int(word(&bytes[std::size_t(v)*width], width))-1;
+	return color;
+}
+
+/**
+ * what verify found
+ */
+struct coloring_report {
+	bool valid;							// every vertex colored and no edge has both ends the same color
+	std::size_t conflicts;				// edges with both ends the same color
+	std::size_t uncolored;				// vertices with a negative color
+	int conflict_u, conflict_v;			// the conflict with the smallest ids, or -1, -1
+	std::vector<std::size_t> histogram;	// vertices of each color
+};
+
+template<typename T>
+/**
+ * checks a coloring of g on every thread of pool: counts the edges whose
+ * ends share a color and the uncolored vertices, and the size of each color class
+ * @param color color of every vertex id
+ */
+coloring_report verify(const csr_graph<T> &g, const std::vector<int> &color, thread_pool &pool) {
+	struct tally {
+		std::size_t conflicts = 0, uncolored = 0;
+		int u = -1, v = -1;
+		std::vector<std::size_t> histogram;
+	};
+	std::vector<tally> part(pool.size());
+	pool.parallel_for(g.vertices(), [&](std::size_t begin, std::size_t end, unsigned w){
+		tally &t = part[w];
+		for (std::size_t v=begin; v<end; v++) {
+			int c = color[v];
+			if (c<0) {
+				t.uncolored++;
+				continue;
+			}
+			if (std::size_t(c)>=t.histogram.size()) t.histogram.resize(c+1, 0);
+			t.histogram[c]++;
+			for (const int *u=g.begin(v); u!=g.end(v); u++) {
+				if (std::size_t(*u)<=v || color[*u]!=c) continue;
+				if (!t.conflicts++ || int(v)<t.u) t.u = v, t.v = *u;
+			}
+		}
+	});
+	coloring_report r;
+	r.conflicts = r.uncolored = 0;
+	r.conflict_u = r.conflict_v = -1;
+	for (tally &t : part) {
+		r.conflicts += t.conflicts;
+		r.uncolored += t.uncolored;
+		if (t.conflicts && (r.conflict_u<0 || t.u<r.conflict_u)) r.conflict_u = t.u, r.conflict_v = t.v;
+		if (t.histogram.size()>r.histogram.size()) r.histogram.resize(t.histogram.size(), 0);
+		for (std::size_t c=0; c<t.histogram.size(); c++) r.histogram[c] += t.histogram[c];
+	}
+	r.valid = !r.conflicts && !r.uncolored;
+	return r;
+}
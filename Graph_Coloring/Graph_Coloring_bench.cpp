@@ -0,0 +1,471 @@
+//============================================================================
+// Name        : Graph_Coloring_bench.cpp
+// Author      : Matthew Brown
+// Description : Timing runs for the p07 graph and coloring code
+//				 Build with: g++ -std=c++17 -O2 -march=native -pthread Graph_Coloring_bench.cpp
+//				 Runs every section, or only the ones named: ./a.out csr
+//				 DIMACS .col files on the command line are used by the orderings section
+//				 A number on the command line is the edge count for the load section
+//============================================================================
+
+#include "Graph_Coloring.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+static vector<string> instance_files;	// DIMACS .col files named on the command line
+static long load_edges = 1000000;		// edges in the file the load section writes
+static int failures = 0;				// checks that came out wrong; main exits non-zero if any did
+
+/**
+ * Seconds elapsed while running f once.
+ */
+template<typename fn>
+static double seconds(fn f) {
+	auto start = chrono::steady_clock::now();
+	f();
+	return chrono::duration<double>(chrono::steady_clock::now()-start).count();
+}
+
+/**
+ * e random edges between v vertices (duplicates and self-loops possible).
+ */
+static vector<pair<int, int>> random_edges(int v, long e, unsigned seed = 321) {
+	mt19937 rng(seed);
+	vector<pair<int, int>> edges(e);
+	for (auto &x : edges) x = make_pair(int(rng()%v), int(rng()%v));
+	return edges;
+}
+
+/**
+ * Power-law graph by preferential attachment: each new vertex joins m
+ * vertices picked in proportion to their degree.
+ */
+static vector<pair<int, int>> power_law_edges(int v, int m, unsigned seed = 321) {
+	mt19937 rng(seed);
+	vector<pair<int, int>> edges;
+	vector<int> ends;	// every endpoint so far, so a uniform pick is degree-weighted
+	edges.reserve(long(v)*m);
+	ends.reserve(2L*v*m);
+	for (int i=1; i<v; i++) {
+		for (int j=0; j<m; j++) {
+			int to = ends.empty() ? 0 : ends[rng()%ends.size()];
+			edges.emplace_back(i, to);
+			ends.push_back(i);
+			ends.push_back(to);
+		}
+	}
+	return edges;
+}
+
+/**
+ * Number of colors in a coloring.
+ */
+static int color_count(const vector<int> &color) {
+	int most = -1;
+	for (int c : color) most = max(most, c);
+	return most+1;
+}
+
+/**
+ * Build time and full edge traversal time for graph<T> and csr_graph<T>,
+ * at an average degree of about 10.
+ */
+static void csr() {
+	printf("csr: build and traverse, average degree 10\n");
+	printf("  %10s %-10s %10s %10s\n", "edges", "backend", "build s", "edges s");
+	for (long e=10000; e<=10000000; e*=10) {
+		vector<pair<int, int>> edges = random_edges(e/5, e);
+		long sink = 0;
+		if (e<=1000000) {	// a heap node per adjacency entry: 10^6 edges build in about 2 s; 10^7 would need over 1 GB of nodes
+			graph<int> g;
+			double build = seconds([&]{ for (auto &x : edges) if (x.first!=x.second) g.ins(x.first, x.second); });
+			double walk = seconds([&]{ g.traverseEdges([&](int a, int b){ sink += a^b; }); });
+			printf("  %10ld %-10s %10.3f %10.4f\n", e, "graph", build, walk);
+		}
+		csr_graph<int> *c = nullptr;
+		double build = seconds([&]{ c = new csr_graph<int>(edges); });
+		double walk = seconds([&]{ c->traverseEdges([&](int a, int b){ sink += a^b; }); });
+		printf("  %10ld %-10s %10.3f %10.4f  (checksum %ld)\n", e, "csr_graph", build, walk, sink);
+		delete c;
+	}
+}
+
+/**
+ * graph<string> like the bigisle districts, scaled up: v named vertices,
+ * each joined to three random others. Times inserting the edges, solving,
+ * and looking up every vertex's color.
+ */
+static void lookup() {
+	printf("lookup: graph<string>, 3 edges per named vertex\n");
+	printf("  %8s %10s %10s %10s\n", "vertices", "ins s", "solve s", "color s");
+	for (int v=1000; v<=100000; v*=10) {
+		vector<string> names(v);
+		for (int i=0; i<v; i++) names[i] = "district " + to_string(i);
+		vector<pair<int, int>> edges = random_edges(v, 3L*v);
+		graph<string> g;
+		double ins = seconds([&]{ for (auto &e : edges) if (e.first!=e.second) g.ins(names[e.first], names[e.second]); });
+		solution<string> *soln = nullptr;
+		double solve = seconds([&]{ soln = new solution<string>(g); });
+		long sink = 0;
+		double color = seconds([&]{ for (const string &name : names) sink += soln->color(name); });
+		printf("  %8d %10.3f %10.3f %10.3f  (checksum %ld)\n", v, ins, solve, color, sink);
+		delete soln;
+	}
+}
+
+/**
+ * graph<T>::solver against the greedy engine on a csr_graph, on a random
+ * graph and a power-law graph of 10^6 vertices, both largest degree first.
+ */
+static void greedy() {
+	printf("greedy: 10^6 vertices, largest degree first\n");
+	printf("  %-10s %-16s %10s %8s\n", "graph", "solver", "seconds", "colors");
+	const int v = 1000000;
+	vector<pair<int, int>> random = random_edges(v, 5L*v), power = power_law_edges(v, 5);
+	for (auto *edges : {&random, &power}) {
+		const char *kind = edges==&random ? "random" : "power-law";
+		graph<int> g;
+		for (auto &e : *edges) if (e.first!=e.second) g.ins(e.first, e.second);
+		double solve = seconds([&]{ g.solver(g.root); });
+		vector<int> color(g.vert);
+		for (int i=0; i<g.vert; i++) color[i] = g.vertex(i)->nodecolor;
+		printf("  %-10s %-16s %10.3f %8d\n", kind, "graph::solver", solve, color_count(color));
+
+		csr_graph<int> c(*edges);
+		vector<int> order(c.vertices());
+		for (int i=0; i<c.vertices(); i++) order[i] = i;
+		stable_sort(order.begin(), order.end(), [&](int a, int b){ return c.degree(a)>c.degree(b); });
+		double engine = seconds([&]{ color = greedy_color(c, order); });
+		printf("  %-10s %-16s %10.3f %8d\n", kind, "greedy_color", engine, color_count(color));
+	}
+}
+
+/**
+ * DIMACS text for the n x n queen graph (squares joined when a queen on one attacks the other).
+ */
+static string queen_dimacs(int n) {
+	ostringstream out;
+	out << "c queen" << n << '_' << n << "\np edge " << n*n << " 0\n";
+	for (int a=0; a<n*n; a++)
+		for (int b=a+1; b<n*n; b++) {
+			int dr = b/n-a/n, dc = b%n-a%n;
+			if (!dr || !dc || dr==dc || dr==-dc) out << "e " << a+1 << ' ' << b+1 << '\n';
+		}
+	return out.str();
+}
+
+/**
+ * DIMACS text for the Mycielski graph of order k (triangle-free, chromatic number k).
+ */
+static string myciel_dimacs(int k) {
+	vector<pair<int, int>> edges = {{1, 2}};
+	int n = 2;
+	for (int order=3; order<=k; order++) {
+		vector<pair<int, int>> next = edges;
+		for (auto &e : edges) {
+			next.emplace_back(e.first, e.second+n);
+			next.emplace_back(e.second, e.first+n);
+		}
+		for (int v=1; v<=n; v++) next.emplace_back(v+n, 2*n+1);
+		edges = next;
+		n = 2*n+1;
+	}
+	ostringstream out;
+	out << "c myciel" << k << "\np edge " << n << ' ' << edges.size() << '\n';
+	for (auto &e : edges) out << "e " << e.first << ' ' << e.second << '\n';
+	return out.str();
+}
+
+/**
+ * DIMACS text for a graph given by its edges.
+ */
+static string edges_dimacs(const string &name, const vector<pair<int, int>> &edges) {
+	ostringstream out;
+	out << "c " << name << "\np edge 0 " << edges.size() << '\n';
+	for (auto &e : edges) out << "e " << e.first+1 << ' ' << e.second+1 << '\n';
+	return out.str();
+}
+
+/**
+ * Colors used and time for each ordering strategy, on the DIMACS files named
+ * on the command line, or on generated instances in DIMACS form if none are.
+ */
+static void orderings() {
+	vector<pair<string, string>> instances;	// (name, DIMACS text)
+	for (const string &file : instance_files) {
+		ifstream in(file);
+		ostringstream text;
+		text << in.rdbuf();
+		instances.emplace_back(file, text.str());
+	}
+	if (instances.empty()) {
+		instances.emplace_back("queen8_8", queen_dimacs(8));
+		instances.emplace_back("queen13_13", queen_dimacs(13));
+		instances.emplace_back("myciel6", myciel_dimacs(6));
+		instances.emplace_back("myciel7", myciel_dimacs(7));
+		instances.emplace_back("random 10^4 x 10", edges_dimacs("random", random_edges(10000, 50000)));
+		instances.emplace_back("power-law 10^5", edges_dimacs("power-law", power_law_edges(100000, 5)));
+	}
+	printf("orderings: colors used / milliseconds\n");
+	printf("  %-22s %8s %9s %15s %15s %15s\n", "instance", "vertices", "edges", "largest_first", "smallest_last", "dsatur");
+	for (auto &inst : instances) {
+		istringstream in(inst.second);
+		csr_graph<int> g(read_dimacs(in));
+		printf("  %-22s %8d %9zu", inst.first.c_str(), g.vertices(), g.edges());
+		for (coloring_order how : {coloring_order::largest_first, coloring_order::smallest_last, coloring_order::dsatur}) {
+			vector<int> color;
+			double t = seconds([&]{ color = color_graph(g, how); });
+			printf(" %6d %8.2f", color_count(color), t*1e3);
+		}
+		printf("\n");
+	}
+}
+
+/**
+ * Strong scaling of Jones-Plassmann and speculative coloring from one thread
+ * to all of them, on a random graph with 10^7 edges, next to sequential greedy.
+ */
+static void parallel() {
+	csr_graph<int> g(random_edges(2000000, 10000000));
+	vector<int> order(g.vertices()), color;
+	for (int v=0; v<g.vertices(); v++) order[v] = v;
+	double greedy = seconds([&]{ color = greedy_color(g, order); });
+	printf("parallel: %d vertices, %zu edges; sequential greedy %.3f s, %d colors\n", g.vertices(), g.edges(), greedy, color_count(color));
+	printf("  %7s %12s %8s %12s %8s\n", "threads", "JP s", "colors", "spec s", "colors");
+	unsigned most = max(1u, thread::hardware_concurrency());
+	for (unsigned t=1; t<=most; t = t<most && 2*t>most ? most : 2*t) {
+		thread_pool pool(t);
+		vector<int> jp, spec;
+		double a = seconds([&]{ jp = jones_plassmann_color(g, pool); });
+		double b = seconds([&]{ spec = speculative_color(g, pool); });
+		printf("  %7u %12.3f %8d %12.3f %8d\n", t, a, color_count(jp), b, color_count(spec));
+	}
+}
+
+/**
+ * Exact coloring on small instances, one thread and all of them, against the
+ * DSatur heuristic it starts from. Each search gets a 10 second budget; an
+ * unproved result is marked with '?'.
+ */
+static void exact() {
+	vector<pair<string, string>> instances = {
+		{"queen7_7", queen_dimacs(7)},
+		{"queen8_8", queen_dimacs(8)},
+		{"myciel4", myciel_dimacs(4)},
+		{"myciel5", myciel_dimacs(5)},
+		{"random 50 x 0.3", edges_dimacs("random", random_edges(50, 368))},
+		{"random 100 x 0.1", edges_dimacs("random", random_edges(100, 495))},
+		{"random 150 x 0.05", edges_dimacs("random", random_edges(150, 559))},
+		{"random 200 x 0.05", edges_dimacs("random", random_edges(200, 995))},
+	};
+	unsigned most = max(1u, thread::hardware_concurrency());
+	printf("exact: colors (clique bound), search nodes, seconds\n");
+	printf("  %-18s %8s %6s %18s %10s %8s %18s %10s %8s\n", "instance", "vertices", "dsatur",
+			"1 thread", "nodes", "s", (to_string(most)+" threads").c_str(), "nodes", "s");
+	for (auto &inst : instances) {
+		istringstream in(inst.second);
+		csr_graph<int> g(read_dimacs(in));
+		printf("  %-18s %8d %6d", inst.first.c_str(), g.vertices(), color_count(dsatur_color(g)));
+		for (unsigned t : {1u, most}) {
+			exact_result r;
+			double s = seconds([&]{ r = exact_color(g, 10, t); });
+			printf(" %10d%c (%3d) %10ld %8.2f", r.colors, r.optimal ? ' ' : '?', r.lower_bound, r.nodes, s);
+		}
+		printf("\n");
+	}
+}
+
+/**
+ * Amortized cost per edge of keeping a coloring valid while inserting 10^6
+ * random edges on 10^5 vertices, next to plain inserts and to coloring the
+ * final graph once from scratch, which is what every insert costs without
+ * the incremental repair. Self-loops are dropped, since no coloring allows
+ * them, and both colorings are checked at the end.
+ */
+static void incremental() {
+	const int v = 100000;
+	vector<pair<int, int>> edges = random_edges(v, 1000000);
+	edges.erase(remove_if(edges.begin(), edges.end(), [](const pair<int, int> &e){ return e.first==e.second; }), edges.end());
+	graph<int> plain;
+	colored_graph<int> colored;
+	double ins = seconds([&]{ for (auto &e : edges) plain.ins(e.first, e.second); });
+	double repair = seconds([&]{ for (auto &e : edges) colored.ins(e.first, e.second); });
+	int kept = colored.colors();
+	bool kept_proper = colored.proper();
+	double scratch = seconds([&]{ colored.recolor(); });
+	bool scratch_proper = colored.proper();
+	failures += !kept_proper + !scratch_proper;
+	printf("incremental: %d vertices, %zu edges\n", v, edges.size());
+	printf("  %-24s %10.1f ns/edge\n", "graph::ins", ins*1e9/edges.size());
+	printf("  %-24s %10.1f ns/edge %4d colors %s\n", "colored_graph::ins", repair*1e9/edges.size(), kept,
+			kept_proper ? "proper" : "NOT PROPER");
+	printf("  %-24s %10.1f ms/edge %4d colors %s\n", "recolor after each", scratch*1e3, colored.colors(),
+			scratch_proper ? "proper" : "NOT PROPER");
+}
+
+/**
+ * Repeated queries on one graph: rebuilding it for each query, as the old
+ * destructive traverseVertices forced, against traversing the same graph
+ * again, and against walking one sorted() view taken up front.
+ */
+static void traversal() {
+	const int v = 10000, queries = 20;
+	vector<pair<int, int>> edges = random_edges(v, 100000);
+	long sink = 0;
+	double rebuild = seconds([&]{
+		for (int q=0; q<queries; q++) {
+			graph<int> g;
+			for (auto &e : edges) g.ins(e.first, e.second);
+			g.traverse_vertices([&](int name){ sink += name; });
+		}
+	});
+	graph<int> g;
+	for (auto &e : edges) g.ins(e.first, e.second);
+	double again = seconds([&]{
+		for (int q=0; q<queries; q++) g.traverse_vertices([&](int name){ sink += name; });
+	});
+	double view = seconds([&]{
+		vector<const graph<int>::node*> order = g.sorted();
+		for (int q=0; q<queries; q++)
+			for (const graph<int>::node* p : order) sink += p->data;
+	});
+	double edges_again = seconds([&]{
+		for (int q=0; q<queries; q++) g.traverse_edges([&](int a, int b){ sink += a^b; });
+	});
+	printf("traversal: %d vertices, %zu edges, ms per query (checksum %ld)\n", v, edges.size(), sink);
+	printf("  %-28s %10.3f\n", "rebuild + traverse_vertices", rebuild*1e3/queries);
+	printf("  %-28s %10.3f\n", "traverse_vertices", again*1e3/queries);
+	printf("  %-28s %10.3f\n", "one sorted() view", view*1e3/queries);
+	printf("  %-28s %10.3f\n", "traverse_edges", edges_again*1e3/queries);
+}
+
+/**
+ * Time to load an edge-list file of load_edges random edges (a tenth as many
+ * vertices): load_edge_list on one thread and on all of them, against
+ * reading the pairs with a stream and then building a csr_graph, or
+ * looping over graph<T>::ins (only up to 2 * 10^6 edges; it is far slower).
+ */
+static void load() {
+	const char *path = "Graph_Coloring_bench.edges";
+	int v = max(2L, load_edges/10);
+	{
+		mt19937 rng(321);
+		vector<char> buffer(1<<20);
+		FILE *out = fopen(path, "w");
+		setvbuf(out, buffer.data(), _IOFBF, buffer.size());
+		for (long i=0; i<load_edges; i++) fprintf(out, "%u %u\n", unsigned(rng()%v), unsigned(rng()%v));
+		fclose(out);
+	}
+	printf("load: %ld edges, %d vertices, seconds\n", load_edges, v);
+	unsigned most = max(1u, thread::hardware_concurrency());
+	for (unsigned t : {1u, most}) {
+		thread_pool pool(t);
+		csr_graph<int> g;
+		double s = seconds([&]{ g = load_edge_list<int>(path, pool); });
+		printf("  %-26s %10.3f  (%d vertices, %zu edges)\n", ("load_edge_list, "+to_string(t)+" thread"+(t>1 ? "s" : "")).c_str(), s, g.vertices(), g.edges());
+		if (t==most) break;
+	}
+	double stream = seconds([&]{
+		ifstream in(path);
+		vector<pair<int, int>> edges;
+		for (int a, b; in>>a>>b;) edges.emplace_back(a, b);
+		csr_graph<int> g(edges);
+	});
+	printf("  %-26s %10.3f\n", "ifstream + csr_graph", stream);
+	if (load_edges<=2000000) {
+		double ins = seconds([&]{
+			ifstream in(path);
+			graph<int> g;
+			for (int a, b; in>>a>>b;) g.ins(a, b);
+		});
+		printf("  %-26s %10.3f\n", "ifstream + graph::ins", ins);
+	}
+	remove(path);
+}
+
+/**
+ * Checking and exporting a coloring of a random graph with 10^7 edges:
+ * verify on one thread and on all of them, then each export format written
+ * to a file, with its size, and the binary form read back.
+ */
+static void exporting() {
+	csr_graph<int> g(random_edges(2000000, 10000000));
+	vector<int> color = greedy_color(g, largest_first_order(g));
+	printf("export: %d vertices, %zu edges\n", g.vertices(), g.edges());
+	unsigned most = max(1u, thread::hardware_concurrency());
+	for (unsigned t : {1u, most}) {
+		thread_pool pool(t);
+		coloring_report r;
+		double s = seconds([&]{ r = verify(g, color, pool); });
+		failures += !r.valid;
+		printf("  %-19s %10.3f s  valid %d, %zu colors, largest class %zu\n", ("verify, "+to_string(t)+" thread"+(t>1 ? "s" : "")).c_str(), s,
+				r.valid, r.histogram.size(), *max_element(r.histogram.begin(), r.histogram.end()));
+		if (t==most) break;
+	}
+	const char *path = "Graph_Coloring_bench.out";
+	struct {
+		const char *name;
+		void (*write)(ostream&, const csr_graph<int>&, const vector<int>&);
+	} formats[] = {
+		{"dot", [](ostream &out, const csr_graph<int> &g, const vector<int> &color){ write_dot(out, g, color); }},
+		{"csv", [](ostream &out, const csr_graph<int> &g, const vector<int> &color){ write_csv(out, g, color); }},
+		{"binary", [](ostream &out, const csr_graph<int> &, const vector<int> &color){ write_coloring(out, color); }},
+	};
+	for (auto &f : formats) {
+		double s = seconds([&]{
+			ofstream out(path, ios::binary);
+			f.write(out, g, color);
+		});
+		ifstream in(path, ios::binary | ios::ate);
+		double mb = in.tellg()/1e6;
+		printf("  %-19s %10.3f s  %8.1f MB %8.1f MB/s\n", (string("write ")+f.name).c_str(), s, mb, mb/s);
+	}
+	vector<int> back;
+	double s = seconds([&]{
+		ifstream in(path, ios::binary);
+		back = read_coloring(in);
+	});
+	failures += back!=color;
+	printf("  %-19s %10.3f s  same %d\n", "read binary", s, back==color);
+	remove(path);
+}
+
+int main(int argc, char **argv) {
+	struct {
+		const char *name;
+		void (*run)();
+	} sections[] = {
+		{"csr", csr},
+		{"lookup", lookup},
+		{"greedy", greedy},
+		{"orderings", orderings},
+		{"parallel", parallel},
+		{"exact", exact},
+		{"incremental", incremental},
+		{"traversal", traversal},
+		{"load", load},
+		{"export", exporting},
+	};
+	vector<string> names;
+	for (int i=1; i<argc; i++) {
+		string arg = argv[i];
+		if (arg.size()>4 && arg.substr(arg.size()-4)==".col") instance_files.push_back(arg);
+		else if (isdigit((unsigned char)arg[0])) load_edges = atol(arg.c_str());
+		else names.push_back(arg);
+	}
+	for (auto &s : sections)
+		if (names.empty() || find(names.begin(), names.end(), s.name)!=names.end()) s.run();
+	if (failures) fprintf(stderr, "%d check(s) failed\n", failures);
+	return failures ? 1 : 0;
+}
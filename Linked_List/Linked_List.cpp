@@ -20,7 +20,6 @@ class traversal {
 	const char *suffix = "}";
 	list<> &data;
 	ostringstream ss;
-	int count;
 	void digraph_step(const list<>::node* const&p) {
 		if (!p) return ;
 		if (!p->next) {
@@ -42,12 +41,9 @@ class traversal {
 				"[label="<<p->data<<";shape=oval;color=lightblue;fontcolor=black];"
 				<<endl;
 	}
-	void text_step(const list<>::node* const&p) {
-		cout << (count++&0xF ? ' ': '\n')<< p->data << flush;
-	}
 public:
 	static vector<future<void>> futures;
-	traversal(list<> &data) : data(data),count(0) {
+	traversal(list<> &data) : data(data) {
 	}
 	/**
 	 * Traverse the data structure to return the digraph in dot language as a string
@@ -60,12 +56,19 @@ public:
 		return ss.str();
 	}
 	/**
-	 * Traverse the data structure to print the contents 16 items per row
+	 * Stream the contents 16 items per row to fd through one buffer.
+	 */
+	void inorder(int fd) {
+		cout << flush;
+		write_inorder(data, fd);
+	}
+	/**
+	 * Stream the digraph in dot language to fd, naming nodes by position (n0, n1, ...).
+	 * Only every k-th node (and the last one) is drawn; dashed edges skip the rest.
 	 */
-	void inorder() {
-		count = 0;
-		data.inorder([&](const list<>::node* const&p){if (p) this->text_step(p);});
-		cout << endl;
+	void digraph(int fd, long every = 1) {
+		cout << flush;
+		write_digraph(data, fd, every);
 	}
 	/**
 	 * Return the string that can be used to launch xdot from the system prompt.
@@ -100,6 +103,7 @@ vector<future<void>> traversal::futures;
  *  w			show the tree in a window and wait for it to close
  *  x			show the tree in a window and don't wait for it to close
  *  g			show the graphviz program that is used for drawing the data structure
+ *  c 100		show a compact graphviz program drawing every 100th node
  *  s			show the system command that is used for drawing the data structure
  *  =			list the data in order
  *  .			quit (same as q or end of input)
@@ -133,11 +137,15 @@ int main() {
 			case 'g':
 				cout << traversal(data).digraph();
 				break;
+			case 'c': // compact graphviz program, drawing every n-th node
+				cin >> n;
+				traversal(data).digraph(1, n>0 ? n : 1);
+				break;
 			case 's':
 				cout << traversal(data).systemcmd();
 				break;
 			case '=': // list the data using inorder traversal
-				traversal(data).inorder();
+				traversal(data).inorder(1);
 				break;
 			case '?':
 				cout <<
@@ -147,6 +155,7 @@ int main() {
 				 "  w       show the tree in a window and wait for it to close\n"
 				 "  x       show the tree in a window and don't wait for it to close\n"
 				 "  g       show the graphviz program that is used for drawing the data structure\n"
+				 "  c 100   show a compact graphviz program drawing every 100th node\n"
 				 "  s       show the system command that is used for drawing the data structure\n"
 				 "  =       list the data in order\n"
 				 "  .       quit (same as q or end of input)" << endl;
@@ -5,14 +5,160 @@
  *      Author: Matthew Brown cs321x1
  */
 
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <vector>
+#include <unistd.h>
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+/**
+ * Shared state of pool_allocator and all its copies and rebinds: a free list
+ * per slot size, and the chunks that own the slots.
+ */
+class slot_pool {
+public:
+	/**
+	 * A free slot holds the link to the next free slot, a used one holds an object.
+	 */
+	struct link {
+		link *next;
+	};
+	/**
+	 * Free list and chunk growth for one slot size.
+	 */
+	struct size_class {
+		std::size_t size;
+		link *free = nullptr;
+		std::size_t grow = 32;
+		explicit size_class(std::size_t size) : size(size){}
+	};
+	slot_pool() = default;
+	slot_pool(const slot_pool&) = delete;
+	slot_pool &operator=(const slot_pool&) = delete;
+	~slot_pool() {
+		for (void* c : chunks) ::operator delete(c);
+	}
+	/**
+	 * the size class for slots of the given size, made on first use
+	 */
+	size_class *get(std::size_t size) {
+		for (auto &c : classes) if (c->size==size) return c.get();
+		classes.emplace_back(new size_class(size));
+		return classes.back().get();
+	}
+	/**
+	 * Allocates the next chunk for c and threads its slots onto c's free list.
+	 * Post: the free list is not empty and the next chunk will be twice as large (up to 4096 slots).
+	 */
+	void refill(size_class *c) {
+		char* chunk = static_cast<char*>(::operator new(c->grow*c->size));
+		chunks.push_back(chunk);
+		for (std::size_t i=0; i<c->grow; i++)
+			c->free = new (chunk+i*c->size) link{c->free};
+		if (c->grow<4096) c->grow *= 2;
+	}
+private:
+	std::vector<std::unique_ptr<size_class>> classes;
+	std::vector<void*> chunks;
+};
+
+/**
+ * Free-list pool allocator for list nodes.
+ * Single objects are carved out of chunks that grow geometrically and are
+ * recycled through a free list instead of going back to the heap, so
+ * insert/delete churn only touches malloc when the pool has to grow.
+ * Copies and rebinds share one slot_pool, which keeps a free list per slot
+ * size, so a list given a pool_allocator<T> draws its nodes from the
+ * caller's pool and A(B(a)) == a holds as the allocator rules require.
+ */
+template<typename T>
+class pool_allocator {
+	template<typename U> friend class pool_allocator;
+	typedef slot_pool::link link;
+	/**
+	 * Slot size for T: room for the object or a link, in steps of a pointer,
+	 * so every type of a given slot size is aligned in chunks from operator new.
+	 */
+	static constexpr std::size_t slot_size =
+			((sizeof(T)>sizeof(link) ? sizeof(T) : sizeof(link))+alignof(link)-1)/alignof(link)*alignof(link);
+	static_assert(alignof(T)<=alignof(std::max_align_t), "pool_allocator does not handle over-aligned types");
+
+	std::shared_ptr<slot_pool> p;
+	slot_pool::size_class *c;		// p's free list for slot_size
+public:
+	typedef T value_type;
+
+	/**
+	 * Default constructor for pool_allocator. Starts with an empty pool.
+	 */
+	pool_allocator() : p(std::make_shared<slot_pool>()), c(p->get(slot_size)){}
+	/**
+	 * Rebinding constructor. Shares x's pool, using its free list for slots of T's size.
+	 */
+	template<typename U>
+	pool_allocator(const pool_allocator<U> &x) : p(x.p), c(p->get(slot_size)){}
+
+	/**
+	 * Allocates storage for n objects. Single objects come from the free list.
+	 * @param n number of objects
+	 * @return uninitialized storage for n objects of type T.
+	 */
+	T* allocate(std::size_t n) {
+		if (n!=1) return static_cast<T*>(::operator new(n*sizeof(T)));
+		if (!c->free) p->refill(c);
+		link* s = c->free;
+		c->free = s->next;
+		return reinterpret_cast<T*>(s);
+	}
+	/**
+	 * Returns storage from allocate. Single objects go back onto the free list.
+	 * @param t storage to release
+	 * @param n number of objects it was allocated for
+	 */
+	void deallocate(T* t, std::size_t n) {
+		if (n!=1){
+			::operator delete(t);
+			return;
+		}
+		c->free = new (t) link{c->free};
+	}
+
+	template<typename A, typename B>
+	friend bool operator==(const pool_allocator<A> &a, const pool_allocator<B> &b);
+};
+
+/**
+ * Allocators are equal when they share a pool, whatever types they are bound to.
+ */
+template<typename A, typename B>
+bool operator==(const pool_allocator<A> &a, const pool_allocator<B> &b) {
+	return a.p==b.p;
+}
+template<typename A, typename B>
+bool operator!=(const pool_allocator<A> &a, const pool_allocator<B> &b) {
+	return !(a==b);
+}
+
 
 /**
  * Data structure for a linked list.
  * Uses a node struct to handle the data storage.
  * Has public accessor functions ins, del, inorder to handle user input
  * and private accessor functions to deal with the behind-the-scenes stuff
+ * Nodes come from Alloc (rebound to node), e.g. pool_allocator<T> to recycle them.
  */
-template<typename T=int>
+template<typename T=int, typename Alloc=std::allocator<T>>
 class list {
 public:
 	/**
@@ -33,12 +179,22 @@ public:
 		 */
 		node(T data, node* next = nullptr) : data(data), next(next){}
 	};
+	typedef typename std::allocator_traits<Alloc>::template rebind_alloc<node> node_allocator;
 
 	/**
 	 * Default constructor for list class.
+	 * @param alloc allocator to take the nodes from.
 	 * Post: Initializes root to a nullptr.
 	 */
-	list() : root(nullptr){}
+	list(const Alloc& alloc = Alloc()) : root(nullptr), alloc(alloc){}
+	/**
+	 * Destructor for list class. Returns every node to the allocator.
+	 */
+	~list() {
+		del();
+	}
+	list(const list&) = delete;
+	list& operator=(const list&) = delete;
 
 	/**
 	 * Goes through the linked list and calls f for each node.
@@ -77,8 +233,62 @@ public:
     	root = nullptr;
     }
 
+	/**
+	 * @return the first node, or nullptr if the list is empty.
+	 */
+	node* front() const {
+		return root;
+	}
+
+	/**
+	 * Links a new node right after pred without searching, like std::forward_list.
+	 * The caller keeps the list sorted and free of duplicates.
+	 * @param pred node to insert after, or nullptr to insert at the front.
+	 * @param n data for the new node.
+	 * @return the new node.
+	 */
+	node* insert_after(node* pred, T n) {
+		node* &p = pred ? pred->next : root;
+		p = make(n, p);
+		return p;
+	}
+
+	/**
+	 * Deletes the node right after pred without searching.
+	 * @param pred node before the one to delete, or nullptr to delete the front node.
+	 */
+	void erase_after(node* pred) {
+		node* &p = pred ? pred->next : root;
+		node* temp = p;
+		p = p->next;
+		destroy(temp);
+	}
+
 private:
+	typedef std::allocator_traits<node_allocator> node_traits;
 	node *root;		// node* root for our linked list to start at
+	node_allocator alloc;	// where the nodes come from
+
+	/**
+	 * Allocates and constructs a node.
+	 * @param n data for the node
+	 * @param next pointer to the next node
+	 * @return the new node.
+	 */
+	node* make(T n, node* next = nullptr) {
+		node* p = node_traits::allocate(alloc, 1);
+		node_traits::construct(alloc, p, n, next);
+		return p;
+	}
+
+	/**
+	 * Destroys a node and gives its storage back to the allocator.
+	 * @param p node to free
+	 */
+	void destroy(node* p) {
+		node_traits::destroy(alloc, p);
+		node_traits::deallocate(alloc, p, 1);
+	}
 
 	/**
 	 * Private delete function for linked list management.
@@ -88,11 +298,11 @@ private:
 	 */
 	void ins(T n, node* &p) {
 		if(!p){
-			p = new node(n);
+			p = make(n);
 			return;
 		}
 		if(n<p->data){
-			p = new node(n,p);
+			p = make(n,p);
 			return;
 		}
 		if(n==p->data){
@@ -113,14 +323,14 @@ private:
 		if (n<p->data) return;
 		if (n==p->data){
 			if (!p->next){
-				delete p;
+				destroy(p);
 				p=0;
 				return;
 			}
 			else {
 				node* temp = p;
 				p = p->next;
-				delete temp;
+				destroy(temp);
 				return;
 			}
 		}
@@ -132,13 +342,15 @@ private:
 	/**
 	 * private delete all function that deletes the entire list.
 	 * @param p pointer to access the current node.
-	 * Post: recursively calls itself until the tree is deleted.
+	 * Post: walks the list freeing each node until the list is deleted.
+	 * Iterative so that destroying a long list cannot overflow the stack.
 	 */
 	void del(node* &p){
-		if(!p) return;
-		del(p->next);
-		delete p;
-		p=0;
+		while(p){
+			node* temp = p;
+			p = p->next;
+			destroy(temp);
+		}
 		return;
 	}
 
@@ -148,11 +360,684 @@ private:
 	 * @param f Function passed from main.
 	 * @param p Accessor for the node we are currently at.
 	 * Post: Calls f for every node in the list.
+	 * Iterative so that long lists cannot overflow the stack.
 	 */
 	void inorder(fn f, node* p){
-		if (!p) return;
-		f(p);
-		inorder(f, p->next);
+		for (; p; p = p->next) f(p);
 		return;
 	}
 };
+
+/**
+ * Hook that a type embeds to be linked into an ilist.
+ * Usage: struct item : ilist_hook<item> { int data; ... };
+ */
+template<typename T>
+struct ilist_hook {
+	T *next = nullptr;
+};
+
+/**
+ * Intrusive linked list with the same sorted-set semantics as list.
+ * The caller's objects carry the link in their ilist_hook, so ins and del
+ * never allocate or free. Objects are ordered with < and == on T, and the
+ * caller keeps them alive for as long as they are linked.
+ */
+template<typename T>
+class ilist {
+public:
+	/**
+	 * Default constructor for ilist class.
+	 * Post: Initializes root to a nullptr.
+	 */
+	ilist() : root(nullptr){}
+
+	/**
+	 * Goes through the linked list and calls f for each object.
+	 * @param f Function that is passed from main.
+	 */
+	template<typename fn>
+	void inorder(fn f) {
+		for (T* p = root; p; p = p->next) f(p);
+	}
+
+	/**
+	 * Links x into its sorted place.
+	 * @param x object to link, must not already be linked.
+	 * @return false if an equal object is already in the list, in which case x is left unlinked.
+	 */
+	bool ins(T &x) {
+		T** p = &root;
+		while (*p && *(*p) < x) p = &(*p)->next;
+		if (*p && *(*p) == x) return false;
+		x.next = *p;
+		*p = &x;
+		return true;
+	}
+
+	/**
+	 * Unlinks the object equal to x.
+	 * @param x key to look for.
+	 * @return the object that was unlinked, or nullptr if there was none.
+	 */
+	T* del(const T &x) {
+		T** p = &root;
+		while (*p && *(*p) < x) p = &(*p)->next;
+		if (!*p || !(*(*p) == x)) return nullptr;
+		T* found = *p;
+		*p = found->next;
+		found->next = nullptr;
+		return found;
+	}
+
+	/**
+	 * Unlinks every object. Nothing is freed since the list does not own them.
+	 */
+	void del() {
+		while (root) {
+			T* temp = root;
+			root = root->next;
+			temp->next = nullptr;
+		}
+	}
+
+private:
+	T *root;		// first linked object
+};
+
+/**
+ * Counts the elements of a[0..n) that are less than key.
+ * Generic version, also used for the tail of the SIMD versions.
+ */
+template<typename T>
+inline std::size_t count_less(const T* a, std::size_t n, T key) {
+	std::size_t c = 0;
+	for (std::size_t i=0; i<n; i++) c += a[i]<key;
+	return c;
+}
+
+#if defined(__SSE2__)
+/**
+ * 32-bit integer version of count_less, 8 lanes per compare with AVX2 and 4 with SSE2.
+ */
+inline std::size_t count_less(const std::int32_t* a, std::size_t n, std::int32_t key) {
+	std::size_t c = 0, i = 0;
+#if defined(__AVX2__)
+	const __m256i k = _mm256_set1_epi32(key);
+	for (; i+8<=n; i+=8) {
+		__m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a+i));
+		c += __builtin_popcount(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(k, v))));
+	}
+#endif
+	const __m128i k4 = _mm_set1_epi32(key);
+	for (; i+4<=n; i+=4) {
+		__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a+i));
+		c += __builtin_popcount(_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(k4, v))));
+	}
+	return c + count_less<std::int32_t>(a+i, n-i, key);
+}
+#endif
+
+#if defined(__AVX2__)
+/**
+ * 64-bit integer version of count_less, 4 lanes per compare with AVX2.
+ */
+inline std::size_t count_less(const std::int64_t* a, std::size_t n, std::int64_t key) {
+	std::size_t c = 0, i = 0;
+	const __m256i k = _mm256_set1_epi64x(key);
+	for (; i+4<=n; i+=4) {
+		__m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a+i));
+		c += __builtin_popcount(_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(k, v))));
+	}
+	return c + count_less<std::int64_t>(a+i, n-i, key);
+}
+#endif
+
+/**
+ * Branchless lower bound over a sorted array.
+ * Halves the range with a conditional move until at most 16 elements are
+ * left, then counts the smaller ones with count_less (SIMD for int keys).
+ * @return index of the first element of a[0..n) that is not less than key.
+ */
+template<typename T>
+inline std::size_t flat_lower_bound(const T* a, std::size_t n, T key) {
+	const T* base = a;
+	while (n>16) {
+		std::size_t half = n/2;
+		base = base[half-1]<key ? base+half : base;
+		n -= half;
+	}
+	return (base-a) + count_less(base, n, key);
+}
+
+/**
+ * Sorted-set list stored in one contiguous buffer.
+ * Same ins/del/inorder interface as list, but finds the insertion point with
+ * flat_lower_bound and shifts with memmove, so T must be trivially copyable.
+ * inorder passes a node* whose data member is the key; there is no next.
+ */
+template<typename T=int>
+class flat_list {
+	static_assert(std::is_trivially_copyable<T>::value, "flat_list needs a trivially copyable T");
+public:
+	/**
+	 * Element of the buffer, laid out exactly like a T.
+	 */
+	struct node {
+		T data;
+	};
+
+	/**
+	 * Default constructor for flat_list class.
+	 * Post: an empty list with no buffer.
+	 */
+	flat_list() : buf(nullptr), count(0), cap(0){}
+	/**
+	 * Destructor for flat_list class. Frees the buffer.
+	 */
+	~flat_list() {
+		std::free(buf);
+	}
+	flat_list(const flat_list&) = delete;
+	flat_list& operator=(const flat_list&) = delete;
+
+	/**
+	 * Calls f for each element in order.
+	 * @param f Function that is passed from main.
+	 */
+	template<typename fn>
+	void inorder(fn f) {
+		for (std::size_t i=0; i<count; i++) f(&buf[i]);
+	}
+
+	/**
+	 * Inserts n in its sorted place unless it is already there.
+	 * @param n Data that the user wants to insert.
+	 */
+	void ins(T n) {
+		std::size_t i = find(n);
+		if (i<count && buf[i].data==n) return;
+		if (count==cap) grow();
+		std::memmove(buf+i+1, buf+i, (count-i)*sizeof(node));
+		buf[i].data = n;
+		count++;
+	}
+
+	/**
+	 * Deletes n if it is in the list.
+	 * @param n Data point that the user wants to delete.
+	 */
+	void del(T n) {
+		std::size_t i = find(n);
+		if (i==count || !(buf[i].data==n)) return;
+		std::memmove(buf+i, buf+i+1, (count-i-1)*sizeof(node));
+		count--;
+	}
+
+	/**
+	 * Deletes every element. The buffer is kept for reuse.
+	 */
+	void del() {
+		count = 0;
+	}
+
+	/**
+	 * @return number of elements in the list.
+	 */
+	std::size_t size() const {
+		return count;
+	}
+
+private:
+	static_assert(sizeof(node)==sizeof(T), "node must have the layout of T");
+	node *buf;			// sorted elements
+	std::size_t count;	// elements in use
+	std::size_t cap;	// elements allocated
+
+	/**
+	 * @return index of the first element not less than n.
+	 */
+	std::size_t find(T n) const {
+		return flat_lower_bound(reinterpret_cast<const T*>(buf), count, n);
+	}
+
+	/**
+	 * Doubles the capacity of the buffer (at least 16 elements).
+	 */
+	void grow() {
+		std::size_t want = cap ? 2*cap : 16;
+		node* p = static_cast<node*>(std::realloc(buf, want*sizeof(node)));
+		if (!p) throw std::bad_alloc();
+		buf = p;
+		cap = want;
+	}
+};
+
+/**
+ * Sorted-set list backend for T: flat_list when T is trivially copyable, list otherwise.
+ */
+template<typename T>
+using sorted_list = typename std::conditional<std::is_trivially_copyable<T>::value, flat_list<T>, list<T>>::type;
+
+/**
+ * Sorted linked list with an open-addressing hash index beside it.
+ * The index maps each key to its node and that node's predecessor, so
+ * contains, del and rejecting a duplicate in ins take O(1) expected time
+ * instead of a walk. Inserting a new key still walks to its sorted place,
+ * and inorder still visits the keys in sorted order.
+ */
+template<typename T=int, typename Alloc=std::allocator<T>, typename Hash=std::hash<T>>
+class hashed_list {
+public:
+	typedef typename list<T, Alloc>::node node;
+
+	/**
+	 * Default constructor for hashed_list class.
+	 * @param alloc allocator to take the nodes from.
+	 */
+	hashed_list(const Alloc& alloc = Alloc()) : items(alloc), used(0), shift(64-4), table(16){}
+
+	/**
+	 * Goes through the linked list in sorted order and calls f for each node.
+	 * @param f Function that is passed from main.
+	 */
+	template<typename fn>
+	void inorder(fn f) {
+		items.inorder(f);
+	}
+
+	/**
+	 * @param n key to look for.
+	 * @return true if n is in the list.
+	 */
+	bool contains(T n) const {
+		return table[probe(n)].at;
+	}
+
+	/**
+	 * Inserts n in its sorted place unless it is already there.
+	 * @param n Data that the user wants to insert.
+	 */
+	void ins(T n) {
+		if (contains(n)) return;
+		if (2*(used+1)>table.size()) rehash(2*table.size());
+		node* pred = nullptr;
+		for (node* p = items.front(); p && p->data<n; p = p->next) pred = p;
+		node* x = items.insert_after(pred, n);
+		put(x, pred);
+		if (x->next) table[probe(x->next->data)].pred = x;
+	}
+
+	/**
+	 * Deletes n if it is in the list.
+	 * @param n Data point that the user wants to delete.
+	 */
+	void del(T n) {
+		std::size_t i = probe(n);
+		if (!table[i].at) return;
+		node* pred = table[i].pred;
+		node* succ = table[i].at->next;
+		erase_slot(i);
+		items.erase_after(pred);
+		if (succ) table[probe(succ->data)].pred = pred;
+	}
+
+	/**
+	 * Deletes every element and empties the index.
+	 */
+	void del() {
+		items.del();
+		std::fill(table.begin(), table.end(), slot());
+		used = 0;
+	}
+
+	/**
+	 * @return number of elements in the list.
+	 */
+	std::size_t size() const {
+		return used;
+	}
+
+private:
+	/**
+	 * Index entry: the node holding a key and the node before it. Empty when at is nullptr.
+	 */
+	struct slot {
+		node *at = nullptr;
+		node *pred = nullptr;
+	};
+	list<T, Alloc> items;		// the sorted list itself
+	std::size_t used;			// keys in the index
+	int shift;					// 64 - log2(table size)
+	std::vector<slot> table;	// linear-probing table, at most half full
+	Hash hash;
+
+	/**
+	 * @return the slot where n should be, by Fibonacci hashing of Hash(n).
+	 */
+	std::size_t home(const T &n) const {
+		return (std::uint64_t(hash(n))*0x9E3779B97F4A7C15ULL)>>shift;
+	}
+
+	/**
+	 * @return the slot holding n, or the empty slot where the probe for n stopped.
+	 */
+	std::size_t probe(const T &n) const {
+		std::size_t mask = table.size()-1, i = home(n);
+		while (table[i].at && !(table[i].at->data==n)) i = (i+1)&mask;
+		return i;
+	}
+
+	/**
+	 * Adds an entry for node x, which must not be in the index yet.
+	 */
+	void put(node* x, node* pred) {
+		slot &s = table[probe(x->data)];
+		s.at = x;
+		s.pred = pred;
+		used++;
+	}
+
+	/**
+	 * Empties slot i, shifting later entries of the probe run back so no tombstone is needed.
+	 */
+	void erase_slot(std::size_t i) {
+		std::size_t mask = table.size()-1;
+		for (std::size_t j = (i+1)&mask; table[j].at; j = (j+1)&mask) {
+			std::size_t k = home(table[j].at->data);
+			// the entry at j may move to i only if its home is not cyclically in (i, j]
+			if ((i<j) ? (k<=i || k>j) : (k<=i && k>j)) {
+				table[i] = table[j];
+				i = j;
+			}
+		}
+		table[i] = slot();
+		used--;
+	}
+
+	/**
+	 * Rebuilds the index with size slots (a power of two) by walking the list.
+	 */
+	void rehash(std::size_t size) {
+		table.assign(size, slot());
+		shift = 64;
+		for (std::size_t s = size; s>1; s >>= 1) shift--;
+		used = 0;
+		node* pred = nullptr;
+		for (node* p = items.front(); p; p = p->next) {
+			put(p, pred);
+			pred = p;
+		}
+	}
+};
+
+/**
+ * Doubly linked version of list with a tail pointer.
+ * Same sorted-set ins/del/inorder interface, plus bidirectional iterators,
+ * reverse_inorder, O(1) pop_front/pop_back and O(1) erase by iterator, so
+ * descending scans need no copy.
+ */
+template<typename T=int, typename Alloc=std::allocator<T>>
+class dlist {
+public:
+	/**
+	 * Stores the data of the linked list in nodes linked both ways.
+	 */
+	struct node {
+		T data;
+		node *next, *prev;
+		/**
+		 * Overloaded constructor for node.
+		 * @param data data the user wants to insert
+		 * @param next pointer to the next node
+		 * @param prev pointer to the previous node
+		 */
+		node(T data, node* next = nullptr, node* prev = nullptr) : data(data), next(next), prev(prev){}
+	};
+	typedef typename std::allocator_traits<Alloc>::template rebind_alloc<node> node_allocator;
+
+	/**
+	 * Bidirectional iterator over the keys. Keys are read-only since they keep the list sorted.
+	 */
+	class iterator {
+		friend class dlist;
+		node *p;				// current node, nullptr at end()
+		const dlist *owner;		// so that --end() can find the tail
+		iterator(node* p, const dlist* owner) : p(p), owner(owner){}
+	public:
+		typedef std::bidirectional_iterator_tag iterator_category;
+		typedef T value_type;
+		typedef std::ptrdiff_t difference_type;
+		typedef const T* pointer;
+		typedef const T& reference;
+
+		iterator() : p(nullptr), owner(nullptr){}
+		reference operator*() const { return p->data; }
+		pointer operator->() const { return &p->data; }
+		iterator& operator++() { p = p->next; return *this; }
+		iterator& operator--() { p = p ? p->prev : owner->tail; return *this; }
+		iterator operator++(int) { iterator old = *this; ++*this; return old; }
+		iterator operator--(int) { iterator old = *this; --*this; return old; }
+		bool operator==(const iterator &x) const { return p==x.p; }
+		bool operator!=(const iterator &x) const { return p!=x.p; }
+	};
+	typedef iterator const_iterator;
+	typedef std::reverse_iterator<iterator> reverse_iterator;
+	typedef reverse_iterator const_reverse_iterator;
+
+	/**
+	 * Default constructor for dlist class.
+	 * @param alloc allocator to take the nodes from.
+	 * Post: Initializes root and tail to a nullptr.
+	 */
+	dlist(const Alloc& alloc = Alloc()) : root(nullptr), tail(nullptr), count(0), alloc(alloc){}
+	/**
+	 * Destructor for dlist class. Returns every node to the allocator.
+	 */
+	~dlist() {
+		del();
+	}
+	dlist(const dlist&) = delete;
+	dlist& operator=(const dlist&) = delete;
+
+	iterator begin() const { return iterator(root, this); }
+	iterator end() const { return iterator(nullptr, this); }
+	reverse_iterator rbegin() const { return reverse_iterator(end()); }
+	reverse_iterator rend() const { return reverse_iterator(begin()); }
+
+	/**
+	 * Goes through the list from smallest to largest and calls f for each node.
+	 * @param f Function that is passed from main.
+	 */
+	template<typename fn>
+	void inorder(fn f) {
+		for (node* p = root; p; p = p->next) f(p);
+	}
+
+	/**
+	 * Goes through the list from largest to smallest and calls f for each node.
+	 * @param f Function that is passed from main.
+	 */
+	template<typename fn>
+	void reverse_inorder(fn f) {
+		for (node* p = tail; p; p = p->prev) f(p);
+	}
+
+	/**
+	 * Inserts n in its sorted place unless it is already there.
+	 * Values past the current largest are appended at the tail without a walk.
+	 * @param n Data that the user wants to insert.
+	 */
+	void ins(T n) {
+		node* p = root;
+		if (tail && tail->data<n) p = nullptr;
+		else while (p && p->data<n) p = p->next;
+		if (p && p->data==n) return;
+		link_before(p, n);
+	}
+
+	/**
+	 * Deletes n if it is in the list.
+	 * @param n Data point that the user wants to delete.
+	 */
+	void del(T n) {
+		node* p = root;
+		while (p && p->data<n) p = p->next;
+		if (p && p->data==n) unlink(p);
+	}
+
+	/**
+	 * Deletes every node.
+	 */
+	void del() {
+		while (root) unlink(root);
+	}
+
+	/**
+	 * Deletes the node at it.
+	 * @param it position to delete, must not be end().
+	 * @return iterator to the node after it.
+	 */
+	iterator erase(iterator it) {
+		node* next = it.p->next;
+		unlink(it.p);
+		return iterator(next, this);
+	}
+
+	/**
+	 * Deletes the smallest element. The list must not be empty.
+	 */
+	void pop_front() {
+		unlink(root);
+	}
+
+	/**
+	 * Deletes the largest element. The list must not be empty.
+	 */
+	void pop_back() {
+		unlink(tail);
+	}
+
+	/**
+	 * @return number of elements in the list.
+	 */
+	std::size_t size() const {
+		return count;
+	}
+
+private:
+	typedef std::allocator_traits<node_allocator> node_traits;
+	node *root;			// smallest element
+	node *tail;			// largest element
+	std::size_t count;	// elements in the list
+	node_allocator alloc;	// where the nodes come from
+
+	/**
+	 * Creates a node for n and links it in front of p.
+	 * @param p node to insert before, or nullptr to append at the tail.
+	 */
+	void link_before(node* p, T n) {
+		node* prev = p ? p->prev : tail;
+		node* x = node_traits::allocate(alloc, 1);
+		node_traits::construct(alloc, x, n, p, prev);
+		(prev ? prev->next : root) = x;
+		(p ? p->prev : tail) = x;
+		count++;
+	}
+
+	/**
+	 * Unlinks p from its neighbours and frees it.
+	 */
+	void unlink(node* p) {
+		(p->prev ? p->prev->next : root) = p->next;
+		(p->next ? p->next->prev : tail) = p->prev;
+		node_traits::destroy(alloc, p);
+		node_traits::deallocate(alloc, p, 1);
+		count--;
+	}
+};
+
+/**
+ * Buffered output to a file descriptor.
+ * Everything collects in a 64K buffer that goes out with one write per
+ * buffer load (and once at the end), instead of a flush per item.
+ */
+class fdout {
+	int fd;
+	std::size_t used;
+	char buf[1<<16];
+public:
+	fdout(int fd) : fd(fd), used(0) {
+	}
+	~fdout() {
+		flush();
+	}
+	/**
+	 * Write out whatever is buffered.
+	 */
+	void flush() {
+		for (std::size_t done = 0; done<used;) {
+			ssize_t n = ::write(fd, buf+done, used-done);
+			if (n<0 && errno==EINTR) continue;
+			if (n<=0) break;
+			done += n;
+		}
+		used = 0;
+	}
+	fdout &operator<<(char c) {
+		if (used==sizeof buf) flush();
+		buf[used++] = c;
+		return *this;
+	}
+	fdout &operator<<(const char *s) {
+		while (*s) *this << *s++;
+		return *this;
+	}
+	fdout &operator<<(long n) {
+		char digits[24];
+		int i = 0;
+		unsigned long u = n<0 ? 0UL-n : n;
+		do digits[i++] = '0'+u%10; while (u /= 10);
+		if (n<0) digits[i++] = '-';
+		if (used+i>sizeof buf) flush();
+		while (i) buf[used++] = digits[--i];
+		return *this;
+	}
+	fdout &operator<<(int n) {
+		return *this << long(n);
+	}
+};
+
+/**
+ * Streams the elements of data to fd through one fdout buffer, 16 per row.
+ * Works with any of the lists here whose elements are integers.
+ */
+template<typename L>
+void write_inorder(L &data, int fd) {
+	fdout out(fd);
+	int count = 0;
+	data.inorder([&](const typename L::node* p){out << (count++&0xF ? ' ': '\n') << p->data;});
+	out << '\n';
+}
+
+/**
+ * Streams data as a digraph in dot language to fd, naming nodes by position (n0, n1, ...).
+ * Only every k-th node (and the last one) is drawn; dashed edges skip the rest.
+ * Needs a list whose nodes link forward through next.
+ */
+template<typename L>
+void write_digraph(L &data, int fd, long every = 1) {
+	fdout out(fd);
+	long i = 0, last = -1;
+	out << "digraph { rankdir=LR; node[shape=oval;color=lightblue;fontcolor=black];edge[color=gray];\n";
+	data.inorder([&](const typename L::node* p){
+		if (i%every==0 || !p->next) {
+			if (last>=0) out << " n" << last << "->n" << i << (i-last>1 ? "[style=dashed];" : ";");
+			out << " n" << i << "[label=" << p->data << "];\n";
+			last = i;
+		}
+		i++;
+	});
+	if (last>=0) out << " n" << last << "->nil[arrowhead=odot];nil[label=\"\";shape=none];\n";
+	out << "}\n";
+}
@@ -0,0 +1,248 @@
+//============================================================================
+// Name        : Linked_List_bench.cpp
+// Author      : Matthew Brown
+// Description : Timing runs for the p02 list variants
+//				 Build with: g++ -std=c++17 -O2 -march=native Linked_List_bench.cpp
+//============================================================================
+
+#include "Linked_List.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fcntl.h>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <random>
+#include <vector>
+
+using namespace std;
+
+/**
+ * One step of a churn workload: insert or delete a key.
+ */
+struct op {
+	bool insert;
+	int key;
+};
+
+/**
+ * Object with an embedded hook for the intrusive list.
+ */
+struct item : ilist_hook<item> {
+	int data;
+	bool operator<(const item &x) const { return data<x.data; }
+	bool operator==(const item &x) const { return data==x.data; }
+};
+
+/**
+ * Seconds elapsed while running f once.
+ */
+template<typename fn>
+static double seconds(fn f) {
+	auto start = chrono::steady_clock::now();
+	f();
+	return chrono::duration<double>(chrono::steady_clock::now()-start).count();
+}
+
+/**
+ * Random insert/delete stream over a small key range, the same shape as
+ * Linked_List_test_cases.txt but long enough to time.
+ */
+static vector<op> churn_ops(int keys, int count) {
+	mt19937 rng(321);
+	vector<op> ops(count);
+	for (op &o : ops) {
+		o.insert = rng()&1;
+		o.key = rng()%keys;
+	}
+	return ops;
+}
+
+/**
+ * Compare node allocation strategies under insert/delete churn.
+ */
+static void churn() {
+	const int keys = 8, count = 4000000;
+	vector<op> ops = churn_ops(keys, count);
+	long sink = 0;
+
+	double plain = seconds([&]{
+		list<int> data;
+		for (const op &o : ops) o.insert ? data.ins(o.key) : data.del(o.key);
+		data.inorder([&](list<int>::node* p){ sink += p->data; });
+	});
+	double pooled = seconds([&]{
+		list<int, pool_allocator<int>> data;
+		for (const op &o : ops) o.insert ? data.ins(o.key) : data.del(o.key);
+		data.inorder([&](list<int, pool_allocator<int>>::node* p){ sink += p->data; });
+	});
+	double intrusive = seconds([&]{
+		vector<item> items(keys);
+		for (int i=0; i<keys; i++) items[i].data = i;
+		ilist<item> data;
+		for (const op &o : ops) o.insert ? (void)data.ins(items[o.key]) : (void)data.del(items[o.key]);
+		data.inorder([&](item* p){ sink += p->data; });
+		data.del();
+	});
+
+	printf("churn: %d ops over %d keys (checksum %ld)\n", count, keys, sink);
+	printf("  %-10s %8.1f ns/op\n", "default", plain*1e9/count);
+	printf("  %-10s %8.1f ns/op\n", "pooled", pooled*1e9/count);
+	printf("  %-10s %8.1f ns/op\n", "intrusive", intrusive*1e9/count);
+}
+
+/**
+ * Time ins/del of absent keys and a full inorder pass on list and flat_list
+ * holding n keys, to find the size where the contiguous backend wins.
+ */
+static void crossover() {
+	printf("crossover: ns per ins+del of an absent key, ns per element of inorder\n");
+	printf("  %8s %12s %12s %10s %10s\n", "n", "list", "flat_list", "list", "flat_list");
+	mt19937 rng(321);
+	long sink = 0;
+	for (int n=10; n<=1000000; n*=10) {
+		int probes = max(200, 20000000/n);
+		vector<int> keys(probes);
+		for (int &k : keys) k = 2*(rng()%n)+1;		// odd keys are never in the list
+
+		list<int> nodes;
+		flat_list<int> flat;
+		for (int i=n-1; i>=0; i--) nodes.ins(2*i);	// descending so every insert is at the front
+		for (int i=0; i<n; i++) flat.ins(2*i);		// ascending so every insert is at the back
+
+		double nodes_ops = seconds([&]{ for (int k : keys){ nodes.ins(k); nodes.del(k); } });
+		double flat_ops = seconds([&]{ for (int k : keys){ flat.ins(k); flat.del(k); } });
+		double nodes_walk = seconds([&]{ nodes.inorder([&](list<int>::node* p){ sink += p->data; }); });
+		double flat_walk = seconds([&]{ flat.inorder([&](flat_list<int>::node* p){ sink += p->data; }); });
+
+		printf("  %8d %12.1f %12.1f %10.2f %10.2f\n", n,
+				nodes_ops*1e9/probes, flat_ops*1e9/probes,
+				nodes_walk*1e9/n, flat_walk*1e9/n);
+	}
+	printf("  (checksum %ld)\n", sink);
+}
+
+/**
+ * Time one workload of probes on a list holding the even keys 0 .. 2n-2.
+ */
+template<typename L, typename fn>
+static double per_probe(int n, const vector<int> &probes, fn step) {
+	L data;
+	for (int i=n-1; i>=0; i--) data.ins(2*i);	// descending so every insert is at the front
+	return seconds([&]{ for (int k : probes) step(data, k); })*1e9/probes.size();
+}
+
+/**
+ * Compare list and hashed_list on miss-heavy and hit-heavy workloads.
+ * misses:     del of keys that are not there
+ * duplicates: ins of keys that are already there
+ * hits:       del of a key that is there, then ins to put it back
+ */
+static void hashed() {
+	printf("hashed: ns per probe\n");
+	printf("  %8s %-11s %12s %12s\n", "n", "workload", "list", "hashed_list");
+	mt19937 rng(321);
+	for (int n=100; n<=100000; n*=10) {
+		vector<int> odd(max(2000, 20000000/n)), even(odd.size());
+		for (size_t i=0; i<odd.size(); i++) {
+			even[i] = 2*(rng()%n);
+			odd[i] = even[i]+1;
+		}
+		auto miss = [](auto &data, int k){ data.del(k); };
+		auto dup = [](auto &data, int k){ data.ins(k); };
+		auto hit = [](auto &data, int k){ data.del(k); data.ins(k); };
+		printf("  %8d %-11s %12.1f %12.1f\n", n, "misses", per_probe<list<int>>(n, odd, miss), per_probe<hashed_list<int>>(n, odd, miss));
+		printf("  %8d %-11s %12.1f %12.1f\n", n, "duplicates", per_probe<list<int>>(n, even, dup), per_probe<hashed_list<int>>(n, even, dup));
+		printf("  %8d %-11s %12.1f %12.1f\n", n, "hits", per_probe<list<int>>(n, even, hit), per_probe<hashed_list<int>>(n, even, hit));
+	}
+}
+
+/**
+ * Compare a descending scan and deleting the largest k keys on list, which
+ * has to copy into a vector first, and dlist, which walks back from the tail.
+ */
+static void descending() {
+	const int n = 1000000, k = 100;
+	long sink = 0;
+	list<int> nodes;
+	dlist<int> doubly;
+	for (int i=n-1; i>=0; i--) nodes.ins(i);	// descending so every insert is at the front
+	for (int i=0; i<n; i++) doubly.ins(i);		// ascending so every insert is at the tail
+
+	double list_scan = seconds([&]{
+		vector<int> copy;
+		nodes.inorder([&](list<int>::node* p){ copy.push_back(p->data); });
+		for (auto it = copy.rbegin(); it!=copy.rend(); ++it) sink += *it;
+	});
+	double dlist_scan = seconds([&]{
+		doubly.reverse_inorder([&](dlist<int>::node* p){ sink += p->data; });
+	});
+	double list_top = seconds([&]{
+		vector<int> copy;
+		nodes.inorder([&](list<int>::node* p){ copy.push_back(p->data); });
+		for (int i=0; i<k; i++) nodes.del(copy[copy.size()-1-i]);
+	});
+	double dlist_top = seconds([&]{
+		for (int i=0; i<k; i++) doubly.pop_back();
+	});
+
+	printf("descending: n = %d (checksum %ld)\n", n, sink);
+	printf("  %-22s %10.2f ms %10.2f ms\n", "scan (list, dlist)", list_scan*1e3, dlist_scan*1e3);
+	printf("  delete largest %-7d %10.2f ms %10.2f ms\n", k, list_top*1e3, dlist_top*1e3);
+}
+
+/**
+ * Time listing and exporting an n-element list to /dev/null: the driver's
+ * old paths (cout with a flush per item, and the dot text built in an
+ * ostringstream with address-based names) against the write_inorder and
+ * write_digraph it now calls, with every node drawn or every 100th.
+ */
+static void output() {
+	const int n = 1000000;
+	list<> data;
+	for (int i=n-1; i>=0; i--) data.ins(i);	// descending so every insert is at the front
+	ofstream null_stream("/dev/null");
+	int null_fd = open("/dev/null", O_WRONLY);
+	typedef list<>::node node;
+
+	streambuf *saved = cout.rdbuf(null_stream.rdbuf());
+	double old_text = seconds([&]{
+		int count = 0;
+		data.inorder([&](const node* p){ cout << (count++&0xF ? ' ': '\n') << p->data << flush; });
+		cout << endl;
+	});
+	cout.rdbuf(saved);
+	double old_dot = seconds([&]{
+		ostringstream ss;
+		ss << "digraph {" << endl;
+		data.inorder([&](const node* p){
+			ss << "  \"" << p->data << "@" << p << "\"->";
+			if (p->next) ss << "\"" << p->next->data << "@" << p->next << "\";";
+			else ss << "\"" << p->data << "@" << p << "null\"[arrowhead=odot];";
+			ss << "\"" << p->data << "@" << p << "\"[label=" << p->data << ";shape=oval;color=lightblue;fontcolor=black];" << endl;
+		});
+		ss << "}" << endl;
+		null_stream << ss.str() << flush;
+	});
+	double new_text = seconds([&]{ write_inorder(data, null_fd); });
+	double new_dot = seconds([&]{ write_digraph(data, null_fd); });
+	double sampled_dot = seconds([&]{ write_digraph(data, null_fd, 100); });
+	close(null_fd);
+
+	printf("output: %d elements to /dev/null\n", n);
+	printf("  %-22s %8.3f s\n", "inorder cout+flush", old_text);
+	printf("  %-22s %8.3f s\n", "write_inorder", new_text);
+	printf("  %-22s %8.3f s\n", "digraph ostringstream", old_dot);
+	printf("  %-22s %8.3f s\n", "write_digraph", new_dot);
+	printf("  %-22s %8.3f s\n", "digraph every 100th", sampled_dot);
+}
+
+int main() {
+	churn();
+	crossover();
+	hashed();
+	descending();
+	output();
+	return 0;
+}